@@ -0,0 +1,14 @@
+#pragma once
+
+#include <QtGlobal>
+
+// Replaces the global operator new and delete with ones that count every allocation
+// made through this executable's operator new. Linking allocationcounter.cpp is what
+// installs them, so only the demo executable does; the library and the tests keep the
+// default allocator.
+namespace AllocationCounter {
+
+quint64 allocations();
+quint64 allocatedBytes();
+
+} // namespace AllocationCounter
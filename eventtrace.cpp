@@ -0,0 +1,415 @@
+#include "eventtrace.h"
+#include "beautyanimationbudget.h"
+
+#include <QEnterEvent>
+#include <QFocusEvent>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QTextStream>
+#include <QTimer>
+#include <QWidget>
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+constexpr quint32 kTraceMagic = 0x42575452; // "BWTR"
+constexpr quint32 kTraceVersion = 1;
+
+bool isTracedEvent(QEvent::Type type)
+{
+    switch (type) {
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseButtonRelease:
+    case QEvent::MouseButtonDblClick:
+    case QEvent::MouseMove:
+    case QEvent::KeyPress:
+    case QEvent::KeyRelease:
+    case QEvent::FocusIn:
+    case QEvent::Enter:
+    case QEvent::Leave:
+        return true;
+    default:
+        return false;
+    }
+}
+
+} // namespace
+
+QDataStream &operator<<(QDataStream &out, const TraceEvent &e)
+{
+    return out << e.time << e.type << e.target << e.pos << e.button << e.buttons
+               << e.modifiers << e.key << e.text << e.autoRepeat << e.focusReason;
+}
+
+QDataStream &operator>>(QDataStream &in, TraceEvent &e)
+{
+    return in >> e.time >> e.type >> e.target >> e.pos >> e.button >> e.buttons
+              >> e.modifiers >> e.key >> e.text >> e.autoRepeat >> e.focusReason;
+}
+
+EventTraceApplication::EventTraceApplication(int &argc, char **argv)
+    : QApplication(argc, argv)
+{
+}
+
+void EventTraceApplication::startProbe()
+{
+    m_report = Report();
+    if (m_allocationCounter) {
+        m_allocationsAtStart = m_allocationCounter();
+    }
+    m_wall.start();
+    m_probing = true;
+}
+
+EventTraceApplication::Report EventTraceApplication::stopProbe()
+{
+    m_probing = false;
+    if (m_allocationCounter) {
+        const Allocations now = m_allocationCounter();
+        m_report.allocations = Allocations { now.count - m_allocationsAtStart.count,
+                                             now.bytes - m_allocationsAtStart.bytes };
+    }
+    m_report.wallMs = m_wall.elapsed();
+    return m_report;
+}
+
+void EventTraceApplication::setAllocationCounter(std::function<Allocations()> counter)
+{
+    m_allocationCounter = std::move(counter);
+}
+
+void EventTraceApplication::setFrameObserver(std::function<void(qint64)> observer)
+{
+    m_frameObserver = std::move(observer);
+}
+
+void EventTraceApplication::setEventObserver(std::function<void(QObject *, QEvent *)> observer)
+{
+    m_eventObserver = std::move(observer);
+}
+
+bool EventTraceApplication::notify(QObject *receiver, QEvent *event)
+{
+    // Propagation to parents happens inside QApplication::notify(), so this sees each
+    // event exactly once.
+    if (m_eventObserver) {
+        m_eventObserver(receiver, event);
+    }
+    if (!m_probing && !m_frameObserver) {
+        return QApplication::notify(receiver, event);
+    }
+
+    const QEvent::Type type = event->type();
+    if (m_probing && type == QEvent::Paint && receiver->isWidgetType()) {
+        ++m_report.paints;
+        const QString name = receiver->objectName();
+        ++m_report.paintsByWidget[name.isEmpty() ? QString::fromLatin1(receiver->metaObject()->className()) : name];
+    }
+
+    // A top-level UpdateRequest is one frame: every dirty widget repaints and the
+    // backing store is flushed before it returns.
+    if (type == QEvent::UpdateRequest && receiver->isWidgetType()
+        && static_cast<QWidget *>(receiver)->isWindow()) {
+        QElapsedTimer frame;
+        frame.start();
+        const bool result = QApplication::notify(receiver, event);
+        const qint64 nanos = frame.nsecsElapsed();
+        if (m_probing) {
+            m_report.frameNanos.append(nanos);
+        }
+        if (m_frameObserver) {
+            m_frameObserver(nanos);
+        }
+        return result;
+    }
+    return QApplication::notify(receiver, event);
+}
+
+EventRecorder::EventRecorder(QWidget *root, EventTraceApplication *app, QObject *parent)
+    : QObject(parent)
+    , m_root(root)
+    , m_app(app)
+{
+}
+
+EventRecorder::~EventRecorder()
+{
+    stop();
+}
+
+bool EventRecorder::start(const QString &path)
+{
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    m_out.setDevice(&m_file);
+    m_out.setVersion(QDataStream::Qt_6_0);
+    m_out << kTraceMagic << kTraceVersion;
+    m_clock.start();
+    m_app->setEventObserver([this](QObject *receiver, QEvent *event) {
+        record(receiver, event);
+    });
+    return true;
+}
+
+void EventRecorder::stop()
+{
+    if (!m_file.isOpen()) {
+        return;
+    }
+    m_app->setEventObserver(nullptr);
+    m_out.setDevice(nullptr);
+    m_file.close();
+}
+
+void EventRecorder::record(QObject *receiver, const QEvent *event)
+{
+    if (!isTracedEvent(event->type()) || !receiver->isWidgetType() || !m_root) {
+        return;
+    }
+    auto *widget = static_cast<QWidget *>(receiver);
+    if (widget->window() != m_root) {
+        return;
+    }
+
+    // Address the event by the nearest named widget so that replays survive layout
+    // differences between machines.
+    QWidget *target = widget;
+    while (target->objectName().isEmpty() && target != m_root) {
+        target = target->parentWidget();
+    }
+
+    TraceEvent e;
+    e.time = m_clock.elapsed();
+    e.type = quint16(event->type());
+    e.target = target->objectName();
+
+    switch (event->type()) {
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseButtonRelease:
+    case QEvent::MouseButtonDblClick:
+    case QEvent::MouseMove: {
+        const auto *me = static_cast<const QMouseEvent *>(event);
+        e.pos = target->mapFrom(widget, me->position());
+        e.button = quint32(me->button());
+        e.buttons = quint32(me->buttons());
+        e.modifiers = quint32(me->modifiers());
+        break;
+    }
+    case QEvent::KeyPress:
+    case QEvent::KeyRelease: {
+        const auto *ke = static_cast<const QKeyEvent *>(event);
+        e.key = ke->key();
+        e.text = ke->text();
+        e.modifiers = quint32(ke->modifiers());
+        e.autoRepeat = ke->isAutoRepeat();
+        break;
+    }
+    case QEvent::FocusIn:
+        e.focusReason = quint8(static_cast<const QFocusEvent *>(event)->reason());
+        break;
+    case QEvent::Enter:
+        e.pos = target->mapFrom(widget, static_cast<const QEnterEvent *>(event)->position());
+        break;
+    default:
+        break;
+    }
+
+    m_out << e;
+}
+
+EventReplayer::EventReplayer(QWidget *root, EventTraceApplication *app, QObject *parent)
+    : QObject(parent)
+    , m_root(root)
+    , m_app(app)
+{
+}
+
+bool EventReplayer::load(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint32 version = 0;
+    in >> magic >> version;
+    if (magic != kTraceMagic || version != kTraceVersion) {
+        return false;
+    }
+
+    m_events.clear();
+    while (!in.atEnd()) {
+        TraceEvent e;
+        in >> e;
+        if (in.status() != QDataStream::Ok) {
+            break; // a truncated tail is expected if the recording was killed
+        }
+        m_events.append(e);
+    }
+    return !m_events.isEmpty();
+}
+
+void EventReplayer::start(bool realTime, const QString &reportPath)
+{
+    m_realTime = realTime;
+    m_reportPath = reportPath;
+    m_next = 0;
+    m_clock.start();
+    m_app->startProbe();
+    playNext();
+}
+
+void EventReplayer::playNext()
+{
+    while (m_next < m_events.size()) {
+        const TraceEvent &e = m_events.at(m_next);
+        if (m_realTime) {
+            const qint64 wait = e.time - m_clock.elapsed();
+            if (wait > 0) {
+                QTimer::singleShot(int(wait), Qt::PreciseTimer, this, &EventReplayer::playNext);
+                return;
+            }
+        }
+        dispatch(e);
+        ++m_next;
+        if (!m_realTime) {
+            // Give queued repaints a turn between events, as a real session would.
+            QTimer::singleShot(0, this, &EventReplayer::playNext);
+            return;
+        }
+    }
+
+    // Let the animations the last events started run out, so their frames are reported.
+    BeautyAnimationBudget &budget = BeautyAnimationBudget::instance();
+    if (budget.activeCount() > 0) {
+        connect(&budget, &BeautyAnimationBudget::idle, this, &EventReplayer::playNext,
+                Qt::ConnectionType(Qt::QueuedConnection | Qt::SingleShotConnection));
+        return;
+    }
+
+    const bool ok = writeReport(m_app->stopProbe());
+    emit finished(ok);
+}
+
+QWidget *EventReplayer::resolve(const QString &name)
+{
+    if (!m_root) {
+        return nullptr;
+    }
+    auto it = m_targets.find(name);
+    if (it != m_targets.end() && *it) {
+        return *it;
+    }
+    QWidget *widget = m_root->objectName() == name ? m_root.data()
+                                                   : m_root->findChild<QWidget *>(name);
+    m_targets.insert(name, widget);
+    return widget;
+}
+
+void EventReplayer::dispatch(const TraceEvent &e)
+{
+    QWidget *widget = resolve(e.target);
+    if (!widget) {
+        return;
+    }
+
+    const auto type = QEvent::Type(e.type);
+    const QPointF global = widget->mapToGlobal(e.pos);
+    const QPointF scene = widget->window()->mapFromGlobal(global);
+    switch (type) {
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseButtonRelease:
+    case QEvent::MouseButtonDblClick:
+    case QEvent::MouseMove: {
+        QMouseEvent event(type, e.pos, scene, global, Qt::MouseButton(e.button),
+                          Qt::MouseButtons(e.buttons), Qt::KeyboardModifiers(e.modifiers));
+        QApplication::sendEvent(widget, &event);
+        break;
+    }
+    case QEvent::KeyPress:
+    case QEvent::KeyRelease: {
+        QKeyEvent event(type, e.key, Qt::KeyboardModifiers(e.modifiers), e.text, e.autoRepeat);
+        QApplication::sendEvent(widget, &event);
+        break;
+    }
+    case QEvent::FocusIn:
+        widget->setFocus(Qt::FocusReason(e.focusReason));
+        break;
+    case QEvent::Enter: {
+        // Hover code asks underMouse(), which only real cursor moves would update.
+        widget->setAttribute(Qt::WA_UnderMouse, true);
+        QEnterEvent event(e.pos, scene, global);
+        QApplication::sendEvent(widget, &event);
+        break;
+    }
+    case QEvent::Leave: {
+        widget->setAttribute(Qt::WA_UnderMouse, false);
+        QEvent event(QEvent::Leave);
+        QApplication::sendEvent(widget, &event);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+bool EventReplayer::writeReport(const EventTraceApplication::Report &report)
+{
+    QFile file;
+    bool opened;
+    if (m_reportPath.isEmpty() || m_reportPath == QLatin1String("-")) {
+        opened = file.open(stdout, QIODevice::WriteOnly);
+    } else {
+        file.setFileName(m_reportPath);
+        opened = file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    }
+    if (!opened) {
+        qCritical("Cannot write report %s: %s", qPrintable(m_reportPath), qPrintable(file.errorString()));
+        return false;
+    }
+    QTextStream out(&file);
+
+    QList<qint64> frames = report.frameNanos;
+    std::sort(frames.begin(), frames.end());
+    auto percentileMs = [&frames](qreal p) {
+        if (frames.isEmpty()) {
+            return 0.0;
+        }
+        const qsizetype i = qMin(frames.size() - 1, qsizetype(p * (frames.size() - 1) + 0.5));
+        return frames.at(i) / 1e6;
+    };
+    qint64 total = 0;
+    for (qint64 f : frames) {
+        total += f;
+    }
+
+    out << "events:      " << m_events.size() << (m_realTime ? " (recorded pace)" : " (fast)") << '\n'
+        << "wall time:   " << report.wallMs << " ms\n"
+        << "frames:      " << frames.size() << '\n'
+        << "frame ms:    avg " << (frames.isEmpty() ? 0.0 : total / 1e6 / frames.size())
+        << "  p50 " << percentileMs(0.5) << "  p95 " << percentileMs(0.95)
+        << "  max " << percentileMs(1.0) << '\n'
+        << "paints:      " << report.paints << '\n';
+    if (report.allocations) {
+        out << "allocations: " << report.allocations->count << " (" << report.allocations->bytes
+            << " bytes)\n";
+    }
+
+    QList<QPair<quint64, QString>> byWidget;
+    for (auto it = report.paintsByWidget.cbegin(); it != report.paintsByWidget.cend(); ++it) {
+        byWidget.append({ it.value(), it.key() });
+    }
+    std::sort(byWidget.begin(), byWidget.end(), [](const auto &a, const auto &b) { return a.first > b.first; });
+    for (qsizetype i = 0; i < qMin<qsizetype>(byWidget.size(), 10); ++i) {
+        out << "  " << byWidget.at(i).second << ": " << byWidget.at(i).first << '\n';
+    }
+    out.flush();
+    return out.status() == QTextStream::Ok && file.error() == QFileDevice::NoError;
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <QApplication>
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPointF>
+#include <QPointer>
+#include <QString>
+
+#include <functional>
+#include <optional>
+
+class QWidget;
+
+// One recorded input event, addressed by the object name of the widget it hit.
+struct TraceEvent {
+    qint64  time { 0 };     // ms since the recording started
+    quint16 type { 0 };     // QEvent::Type
+    QString target;
+    QPointF pos;            // local to target
+    quint32 button { 0 };
+    quint32 buttons { 0 };
+    quint32 modifiers { 0 };
+    qint32  key { 0 };
+    QString text;
+    bool    autoRepeat { false };
+    quint8  focusReason { 0 };
+};
+
+QDataStream &operator<<(QDataStream &out, const TraceEvent &e);
+QDataStream &operator>>(QDataStream &in, TraceEvent &e);
+
+// QApplication that can time frames and count paints while a probe is active.
+class EventTraceApplication final : public QApplication {
+    Q_OBJECT
+
+public:
+    struct Allocations {
+        quint64 count { 0 };
+        quint64 bytes { 0 };
+    };
+
+    struct Report {
+        QList<qint64> frameNanos;
+        quint64 paints { 0 };
+        QHash<QString, quint64> paintsByWidget;
+        std::optional<Allocations> allocations; // only with an allocation counter
+        qint64  wallMs { 0 };
+    };
+
+    EventTraceApplication(int &argc, char **argv);
+
+    void startProbe();
+    Report stopProbe();
+
+    // Running allocation totals of the process, sampled when a probe starts and stops.
+    void setAllocationCounter(std::function<Allocations()> counter);
+    // Called with the duration of every top-level frame, whether or not a probe runs.
+    void setFrameObserver(std::function<void(qint64 nanos)> observer);
+    // Called once per delivered event with its first receiver, before propagation to
+    // parents and before any event filter.
+    void setEventObserver(std::function<void(QObject *receiver, QEvent *event)> observer);
+
+    bool notify(QObject *receiver, QEvent *event) override;
+
+private:
+    bool m_probing { false };
+    std::function<void(qint64)> m_frameObserver;
+    std::function<void(QObject *, QEvent *)> m_eventObserver;
+    Report m_report;
+    QElapsedTimer m_wall;
+    std::function<Allocations()> m_allocationCounter;
+    Allocations m_allocationsAtStart;
+};
+
+// Appends mouse, key, focus and hover events aimed at widgets of root to a trace file.
+class EventRecorder final : public QObject {
+    Q_OBJECT
+
+public:
+    EventRecorder(QWidget *root, EventTraceApplication *app, QObject *parent = nullptr);
+    ~EventRecorder() override;
+    bool start(const QString &path);
+    void stop();
+
+private:
+    void record(QObject *receiver, const QEvent *event);
+
+private:
+    QPointer<QWidget> m_root;
+    EventTraceApplication *m_app;
+    QFile m_file;
+    QDataStream m_out;
+    QElapsedTimer m_clock;
+};
+
+// Plays a trace back against root, either at the recorded pace or as fast as
+// possible, and prints frame times, paint counts and allocations once the widget
+// animations the trace started have finished.
+class EventReplayer final : public QObject {
+    Q_OBJECT
+
+public:
+    EventReplayer(QWidget *root, EventTraceApplication *app, QObject *parent = nullptr);
+    bool load(const QString &path);
+    // Plays events built in code instead of a recording; their times only matter at the
+    // recorded pace.
+    void setEvents(const QList<TraceEvent> &events) { m_events = events; }
+    void start(bool realTime, const QString &reportPath);
+
+signals:
+    // ok is false if the report could not be written.
+    void finished(bool ok);
+
+private:
+    void playNext();
+    void dispatch(const TraceEvent &e);
+    QWidget *resolve(const QString &name);
+    bool writeReport(const EventTraceApplication::Report &report);
+
+private:
+    QPointer<QWidget> m_root;
+    EventTraceApplication *m_app;
+    QList<TraceEvent> m_events;
+    QHash<QString, QPointer<QWidget>> m_targets;
+    qsizetype m_next { 0 };
+    bool m_realTime { true };
+    QString m_reportPath;
+    QElapsedTimer m_clock;
+};
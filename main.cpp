@@ -1,12 +1,18 @@
 #include <QApplication>
+#include <QCommandLineParser>
 #include <QMainWindow>
+#include <QStringList>
+#include <QTimer>
 #include <QWidget>
 #include <QColor>
 
 #include <memory>
 
+#include "allocationcounter.h"
 #include "beautypushbutton.h"
 #include "beautylineedit.h"
+#include "eventtrace.h"
+#include "stresspage.h"
 #include "ui_beautywidgetsdemo.h"
 
 class BeautyWidgetsDemo final : public QMainWindow {
@@ -25,9 +31,87 @@ private:
 };
 
 int main(int argc, char *argv[]) {
-    QApplication app(argc, argv);
-    BeautyWidgetsDemo window;
-    window.show();
+    // Replays run headless unless a platform is chosen explicitly.
+    bool replaying = false;
+    bool explicitPlatform = !qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM");
+    // The same spellings QCommandLineParser and QGuiApplication accept, as neither has
+    // run yet: "--replay <file>", "--replay=<file>", and "-platform" with one or two dashes.
+    for (int i = 1; i < argc; ++i) {
+        const QByteArray arg(argv[i]);
+        if (arg == "--") {
+            break;
+        }
+        replaying |= arg == "--replay" || arg.startsWith("--replay=");
+        explicitPlatform |= arg == "-platform" || arg == "--platform" || arg == "--visible";
+    }
+    if (replaying && !explicitPlatform) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    EventTraceApplication app(argc, argv);
+    app.setAllocationCounter([] {
+        return EventTraceApplication::Allocations { AllocationCounter::allocations(),
+                                                    AllocationCounter::allocatedBytes() };
+    });
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("BeautyWidgets Demo"));
+    parser.addHelpOption();
+    const QCommandLineOption recordOption(QStringLiteral("record"),
+        QStringLiteral("Record mouse, key and focus events to <file>."), QStringLiteral("file"));
+    const QCommandLineOption replayOption(QStringLiteral("replay"),
+        QStringLiteral("Replay a recording from <file> and report frame times, paints and allocations."),
+        QStringLiteral("file"));
+    const QCommandLineOption fastOption(QStringLiteral("fast"),
+        QStringLiteral("Replay as fast as possible instead of at the recorded pace."));
+    const QCommandLineOption reportOption(QStringLiteral("report"),
+        QStringLiteral("Write the replay report to <file> instead of stdout."), QStringLiteral("file"));
+    const QCommandLineOption visibleOption(QStringLiteral("visible"),
+        QStringLiteral("Replay on the default platform instead of offscreen."));
+    const QCommandLineOption stressOption(QStringLiteral("stress"),
+        QStringLiteral("Open the stress page with a <columns>x<rows> grid of widgets instead of the demo."),
+        QStringLiteral("grid"));
+    parser.addOptions({ recordOption, replayOption, fastOption, reportOption, visibleOption,
+                        stressOption });
+    parser.process(app);
+
+    std::unique_ptr<QWidget> window;
+    if (parser.isSet(stressOption)) {
+        const QStringList grid = parser.value(stressOption).split(QLatin1Char('x'));
+        bool columnsOk = false;
+        bool rowsOk = false;
+        const int columns = grid.size() == 2 ? grid.at(0).toInt(&columnsOk) : 0;
+        const int rows = grid.size() == 2 ? grid.at(1).toInt(&rowsOk) : 0;
+        if (!columnsOk || !rowsOk || columns < 1 || rows < 1) {
+            qCritical("Invalid grid %s, expected <columns>x<rows>", qPrintable(parser.value(stressOption)));
+            return 1;
+        }
+        window = std::make_unique<StressPage>(&app, columns, rows);
+    } else {
+        window = std::make_unique<BeautyWidgetsDemo>();
+    }
+    window->show();
+
+    EventRecorder recorder(window.get(), &app);
+    if (parser.isSet(recordOption) && !recorder.start(parser.value(recordOption))) {
+        qCritical("Cannot write %s", qPrintable(parser.value(recordOption)));
+        return 1;
+    }
+
+    EventReplayer replayer(window.get(), &app);
+    if (parser.isSet(replayOption)) {
+        if (!replayer.load(parser.value(replayOption))) {
+            qCritical("Cannot read recording %s", qPrintable(parser.value(replayOption)));
+            return 1;
+        }
+        QObject::connect(&replayer, &EventReplayer::finished, &app, [](bool ok) {
+            QCoreApplication::exit(ok ? 0 : 1);
+        });
+        QTimer::singleShot(0, &replayer, [&] {
+            replayer.start(!parser.isSet(fastOption), parser.value(reportOption));
+        });
+    }
+
     return app.exec();
 }
 
@@ -0,0 +1,158 @@
+#include "beautyanimationbudget.h"
+#include <QAbstractAnimation>
+#include <QPropertyAnimation>
+#include <QWidget>
+
+#include <algorithm>
+
+BeautyAnimationBudget &BeautyAnimationBudget::instance()
+{
+    static BeautyAnimationBudget budget;
+    return budget;
+}
+
+BeautyAnimationBudget::BeautyAnimationBudget(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void BeautyAnimationBudget::setMaxConcurrent(int max)
+{
+    m_maxConcurrent = qMax(0, max);
+    enforce();
+}
+
+BeautyAnimationBudget::Stats BeautyAnimationBudget::stats() const
+{
+    Stats s;
+    s.budget = m_maxConcurrent;
+    s.active = activeCount();
+    s.peak = m_peak;
+    s.started = m_started;
+    s.superseded = m_superseded;
+    s.fastForwarded = m_fastForwarded;
+    return s;
+}
+
+void BeautyAnimationBudget::start(QAbstractAnimation *animation, QWidget *owner)
+{
+    if (!animation) {
+        return;
+    }
+
+    supersede(animation);
+
+    connect(animation, &QAbstractAnimation::stateChanged, this,
+            [this, animation](QAbstractAnimation::State newState, QAbstractAnimation::State) {
+                if (newState == QAbstractAnimation::Stopped) {
+                    release(animation);
+                }
+            });
+    connect(animation, &QObject::destroyed, this, [this, animation] {
+        release(animation);
+    });
+
+    m_running.push_back(Running { animation, owner });
+    ++m_started;
+    animation->start(QAbstractAnimation::DeleteWhenStopped);
+    m_peak = qMax(m_peak, activeCount());
+    enforce();
+}
+
+void BeautyAnimationBudget::stopAll(const QWidget *owner)
+{
+    std::vector<QPointer<QAbstractAnimation>> owned;
+    for (const Running &r : m_running) {
+        if (r.owner == owner && r.animation) {
+            owned.push_back(r.animation);
+        }
+    }
+    for (const auto &a : owned) {
+        if (a) {
+            release(a);
+            a->stop();
+        }
+    }
+}
+
+bool BeautyAnimationBudget::isAnimating(const QWidget *owner) const
+{
+    return std::any_of(m_running.begin(), m_running.end(), [owner](const Running &r) {
+        return r.owner == owner && r.animation;
+    });
+}
+
+void BeautyAnimationBudget::release(QAbstractAnimation *animation)
+{
+    const bool wasRunning = !m_running.empty();
+    m_running.erase(std::remove_if(m_running.begin(), m_running.end(),
+                                   [animation](const Running &r) {
+                                       return r.animation.isNull() || r.animation == animation;
+                                   }),
+                    m_running.end());
+    if (wasRunning && m_running.empty()) {
+        emit idle();
+    }
+}
+
+// A newer animation of the same property starts from the current value, so the
+// older one can simply stop where it is.
+void BeautyAnimationBudget::supersede(QAbstractAnimation *animation)
+{
+    auto *property = qobject_cast<QPropertyAnimation*>(animation);
+    if (!property) {
+        return;
+    }
+
+    std::vector<QAbstractAnimation*> stale;
+    for (const Running &r : m_running) {
+        auto *other = qobject_cast<QPropertyAnimation*>(r.animation.data());
+        if (other && other->targetObject() == property->targetObject()
+            && other->propertyName() == property->propertyName()) {
+            stale.push_back(other);
+        }
+    }
+    for (auto *a : stale) {
+        release(a);
+        a->stop();
+        ++m_superseded;
+    }
+}
+
+void BeautyAnimationBudget::enforce()
+{
+    if (m_maxConcurrent <= 0) {
+        return;
+    }
+
+    while (activeCount() > m_maxConcurrent) {
+        auto victim = std::find_if(m_running.begin(), m_running.end(), [](const Running &r) {
+            return !hasPriority(r.owner);
+        });
+        if (victim == m_running.end()) {
+            victim = m_running.begin();
+        }
+        QPointer<QAbstractAnimation> animation = victim->animation;
+        m_running.erase(victim);
+        if (animation) {
+            finishNow(animation);
+            ++m_fastForwarded;
+        }
+    }
+}
+
+bool BeautyAnimationBudget::hasPriority(const QWidget *owner)
+{
+    return owner && (owner->underMouse() || owner->hasFocus());
+}
+
+void BeautyAnimationBudget::finishNow(QAbstractAnimation *animation)
+{
+    const int total = animation->totalDuration();
+    if (total >= 0) {
+        animation->setCurrentTime(total);
+    }
+    if (animation->state() != QAbstractAnimation::Stopped) {
+        animation->stop();
+    }
+}
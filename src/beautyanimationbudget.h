@@ -0,0 +1,66 @@
+#pragma once
+
+#include <QObject>
+#include <QPointer>
+
+#include <vector>
+
+class QAbstractAnimation;
+class QWidget;
+
+// Global cap on concurrently running widget animations. Sweeping the cursor across a
+// grid would otherwise leave dozens of hover animations running for widgets the
+// cursor has already left. Animations of the widget under the cursor or with focus
+// keep running; beyond the budget, the others jump straight to their end value.
+class BeautyAnimationBudget : public QObject {
+    Q_OBJECT
+
+public:
+    struct Stats {
+        int     budget { 0 };        // 0 means unlimited
+        int     active { 0 };
+        int     peak { 0 };
+        quint64 started { 0 };
+        quint64 superseded { 0 };    // replaced by a newer animation of the same property
+        quint64 fastForwarded { 0 }; // finished early to stay within the budget
+    };
+
+    static BeautyAnimationBudget &instance();
+
+    void setMaxConcurrent(int max);
+    int  maxConcurrent() const { return m_maxConcurrent; }
+    int  activeCount() const { return int(m_running.size()); }
+    Stats stats() const;
+
+    // Starts the animation with DeleteWhenStopped on behalf of owner.
+    void start(QAbstractAnimation *animation, QWidget *owner);
+    // Stops every running animation started on behalf of owner, where it is.
+    void stopAll(const QWidget *owner);
+    bool isAnimating(const QWidget *owner) const;
+
+signals:
+    // The last running animation stopped.
+    void idle();
+
+private:
+    struct Running {
+        QPointer<QAbstractAnimation> animation;
+        QPointer<QWidget> owner;
+    };
+
+    explicit BeautyAnimationBudget(QObject *parent = nullptr);
+
+    void release(QAbstractAnimation *animation);
+    void supersede(QAbstractAnimation *animation);
+    void enforce();
+    static bool hasPriority(const QWidget *owner);
+    static void finishNow(QAbstractAnimation *animation);
+
+private:
+    std::vector<Running> m_running; // oldest first
+    int     m_maxConcurrent { 32 };
+    int     m_peak { 0 };
+    quint64 m_started { 0 };
+    quint64 m_superseded { 0 };
+    quint64 m_fastForwarded { 0 };
+};
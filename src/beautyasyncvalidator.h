@@ -0,0 +1,38 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+
+#include <atomic>
+#include <memory>
+
+// Handed to worker-thread jobs so they can stop early once newer input has arrived.
+class BeautyCancelToken {
+public:
+    BeautyCancelToken() = default;
+    BeautyCancelToken(std::shared_ptr<const std::atomic<quint64>> generation, quint64 ticket)
+        : m_generation(std::move(generation)), m_ticket(ticket) {}
+
+    bool isCanceled() const {
+        return !m_generation || m_generation->load(std::memory_order_relaxed) != m_ticket;
+    }
+
+private:
+    std::shared_ptr<const std::atomic<quint64>> m_generation;
+    quint64 m_ticket { 0 };
+};
+
+// Validation run off the GUI thread by BeautyLineEdit. Implementations must be
+// thread-safe; a canceled job may return anything, its result is dropped.
+class BeautyAsyncValidator {
+public:
+    virtual ~BeautyAsyncValidator() = default;
+    virtual bool validate(const QString &text, const BeautyCancelToken &token) const = 0;
+};
+
+// Completion run off the GUI thread by BeautyLineEdit, same rules as the validator.
+class BeautyAsyncCompleter {
+public:
+    virtual ~BeautyAsyncCompleter() = default;
+    virtual QStringList complete(const QString &text, const BeautyCancelToken &token) const = 0;
+};
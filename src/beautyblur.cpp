@@ -0,0 +1,285 @@
+#include "beautyblur.h"
+#include <QtMath>
+
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define BEAUTY_BLUR_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define BEAUTY_TARGET_AVX2
+#else
+#define BEAUTY_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace {
+
+// A box sum is at most 255 * window and has to fit 16-bit lanes.
+constexpr int kMaxWindow = 255;
+
+struct RowKernels {
+    void (*accumulate)(quint16 *sums, const uchar *row, int width);
+    void (*subtract)(quint16 *sums, const uchar *row, int width);
+    void (*emit)(uchar *dst, const quint16 *sums, quint16 inv, int width);
+};
+
+// ceil(65536 / window): (sum * inv) >> 16 never exceeds 255 for window <= kMaxWindow
+// and a fully opaque window still maps back to 255.
+quint16 reciprocal(int window)
+{
+    return quint16((65536 + window - 1) / window);
+}
+
+void accumulateScalar(quint16 *sums, const uchar *row, int width)
+{
+    for (int x = 0; x < width; ++x) {
+        sums[x] = quint16(sums[x] + row[x]);
+    }
+}
+
+void subtractScalar(quint16 *sums, const uchar *row, int width)
+{
+    for (int x = 0; x < width; ++x) {
+        sums[x] = quint16(sums[x] - row[x]);
+    }
+}
+
+void emitScalar(uchar *dst, const quint16 *sums, quint16 inv, int width)
+{
+    for (int x = 0; x < width; ++x) {
+        dst[x] = uchar((quint32(sums[x]) * inv) >> 16);
+    }
+}
+
+#ifdef BEAUTY_BLUR_X86
+void accumulateSse2(quint16 *sums, const uchar *row, int width)
+{
+    const __m128i zero = _mm_setzero_si128();
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + x));
+        auto *s = reinterpret_cast<__m128i *>(sums + x);
+        _mm_storeu_si128(s, _mm_add_epi16(_mm_loadu_si128(s), _mm_unpacklo_epi8(v, zero)));
+        _mm_storeu_si128(s + 1, _mm_add_epi16(_mm_loadu_si128(s + 1), _mm_unpackhi_epi8(v, zero)));
+    }
+    accumulateScalar(sums + x, row + x, width - x);
+}
+
+void subtractSse2(quint16 *sums, const uchar *row, int width)
+{
+    const __m128i zero = _mm_setzero_si128();
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + x));
+        auto *s = reinterpret_cast<__m128i *>(sums + x);
+        _mm_storeu_si128(s, _mm_sub_epi16(_mm_loadu_si128(s), _mm_unpacklo_epi8(v, zero)));
+        _mm_storeu_si128(s + 1, _mm_sub_epi16(_mm_loadu_si128(s + 1), _mm_unpackhi_epi8(v, zero)));
+    }
+    subtractScalar(sums + x, row + x, width - x);
+}
+
+void emitSse2(uchar *dst, const quint16 *sums, quint16 inv, int width)
+{
+    const __m128i vinv = _mm_set1_epi16(short(inv));
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        const auto *s = reinterpret_cast<const __m128i *>(sums + x);
+        const __m128i lo = _mm_mulhi_epu16(_mm_loadu_si128(s), vinv);
+        const __m128i hi = _mm_mulhi_epu16(_mm_loadu_si128(s + 1), vinv);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x), _mm_packus_epi16(lo, hi));
+    }
+    emitScalar(dst + x, sums + x, inv, width - x);
+}
+
+BEAUTY_TARGET_AVX2 void accumulateAvx2(quint16 *sums, const uchar *row, int width)
+{
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        const __m256i v = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(row + x)));
+        auto *s = reinterpret_cast<__m256i *>(sums + x);
+        _mm256_storeu_si256(s, _mm256_add_epi16(_mm256_loadu_si256(s), v));
+    }
+    accumulateScalar(sums + x, row + x, width - x);
+}
+
+BEAUTY_TARGET_AVX2 void subtractAvx2(quint16 *sums, const uchar *row, int width)
+{
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        const __m256i v = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(row + x)));
+        auto *s = reinterpret_cast<__m256i *>(sums + x);
+        _mm256_storeu_si256(s, _mm256_sub_epi16(_mm256_loadu_si256(s), v));
+    }
+    subtractScalar(sums + x, row + x, width - x);
+}
+
+BEAUTY_TARGET_AVX2 void emitAvx2(uchar *dst, const quint16 *sums, quint16 inv, int width)
+{
+    const __m256i vinv = _mm256_set1_epi16(short(inv));
+    int x = 0;
+    for (; x + 32 <= width; x += 32) {
+        const auto *s = reinterpret_cast<const __m256i *>(sums + x);
+        const __m256i a = _mm256_mulhi_epu16(_mm256_loadu_si256(s), vinv);
+        const __m256i b = _mm256_mulhi_epu16(_mm256_loadu_si256(s + 1), vinv);
+        // packus works per 128-bit lane, restore the element order afterwards.
+        const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + x), packed);
+    }
+    emitSse2(dst + x, sums + x, inv, width - x);
+}
+
+bool cpuHasAvx2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif // BEAUTY_BLUR_X86
+
+RowKernels kernelsFor(BeautyBlur::Backend backend)
+{
+    switch (backend) {
+#ifdef BEAUTY_BLUR_X86
+    case BeautyBlur::Backend::Avx2:
+        return { accumulateAvx2, subtractAvx2, emitAvx2 };
+    case BeautyBlur::Backend::Sse2:
+        return { accumulateSse2, subtractSse2, emitSse2 };
+#endif
+    default:
+        return { accumulateScalar, subtractScalar, emitScalar };
+    }
+}
+
+std::atomic<int> g_backend { -1 };
+
+// Running-sum box filter along each row. Inherently sequential, so it stays scalar.
+void horizontalPass(const uchar *src, int srcStride, uchar *dst, int dstStride,
+                    int width, int height, int r)
+{
+    const quint16 inv = reciprocal(2 * r + 1);
+    for (int y = 0; y < height; ++y) {
+        const uchar *in = src + y * srcStride;
+        uchar *out = dst + y * dstStride;
+        quint32 sum = 0;
+        for (int x = 0; x <= r && x < width; ++x) {
+            sum += in[x];
+        }
+        for (int x = 0; x < width; ++x) {
+            out[x] = uchar((sum * inv) >> 16);
+            if (x + r + 1 < width) {
+                sum += in[x + r + 1];
+            }
+            if (x - r >= 0) {
+                sum -= in[x - r];
+            }
+        }
+    }
+}
+
+// Box filter along each column, driven row by row over a line of 16-bit sums so that
+// every step is a straight vector loop across the width.
+void verticalPass(const uchar *src, int srcStride, uchar *dst, int dstStride,
+                  int width, int height, int r, const RowKernels &k, std::vector<quint16> &sums)
+{
+    const quint16 inv = reciprocal(2 * r + 1);
+    sums.assign(size_t(width), 0);
+    for (int y = 0; y <= r && y < height; ++y) {
+        k.accumulate(sums.data(), src + y * srcStride, width);
+    }
+    for (int y = 0; y < height; ++y) {
+        k.emit(dst + y * dstStride, sums.data(), inv, width);
+        if (y + r + 1 < height) {
+            k.accumulate(sums.data(), src + (y + r + 1) * srcStride, width);
+        }
+        if (y - r >= 0) {
+            k.subtract(sums.data(), src + (y - r) * srcStride, width);
+        }
+    }
+}
+
+// Box widths for three passes approximating a Gaussian of the given sigma.
+void boxesForGauss(qreal sigma, int radii[3])
+{
+    const int n = 3;
+    const qreal wIdeal = qSqrt(12.0 * sigma * sigma / n + 1.0);
+    int wl = qFloor(wIdeal);
+    if (wl % 2 == 0) {
+        --wl;
+    }
+    const int wu = wl + 2;
+    const qreal mIdeal = (12.0 * sigma * sigma - n * wl * wl - 4.0 * n * wl - 3.0 * n) / (-4.0 * wl - 4.0);
+    const int m = qRound(mIdeal);
+    for (int i = 0; i < n; ++i) {
+        const int w = qMin(i < m ? wl : wu, kMaxWindow);
+        radii[i] = qMax(0, (w - 1) / 2);
+    }
+}
+
+} // namespace
+
+namespace BeautyBlur {
+
+Backend bestBackend()
+{
+#ifdef BEAUTY_BLUR_X86
+    static const Backend best = cpuHasAvx2() ? Backend::Avx2 : Backend::Sse2;
+    return best;
+#else
+    return Backend::Scalar;
+#endif
+}
+
+Backend activeBackend()
+{
+    const int b = g_backend.load(std::memory_order_relaxed);
+    return b < 0 ? bestBackend() : Backend(b);
+}
+
+void setBackend(Backend backend)
+{
+    if (int(backend) > int(bestBackend())) {
+        backend = bestBackend();
+    }
+    g_backend.store(int(backend), std::memory_order_relaxed);
+}
+
+void blurAlpha(uchar *data, int width, int height, int stride, qreal sigma)
+{
+    if (!data || width <= 0 || height <= 0 || sigma <= 0) {
+        return;
+    }
+
+    int radii[3];
+    boxesForGauss(sigma, radii);
+
+    const RowKernels kernels = kernelsFor(activeBackend());
+    std::vector<uchar> tmp(size_t(width) * size_t(height));
+    std::vector<quint16> sums;
+    for (int r : radii) {
+        if (r <= 0) {
+            continue;
+        }
+        horizontalPass(data, stride, tmp.data(), width, width, height, r);
+        verticalPass(tmp.data(), width, data, stride, width, height, r, kernels, sums);
+    }
+}
+
+} // namespace BeautyBlur
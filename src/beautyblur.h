@@ -0,0 +1,28 @@
+#pragma once
+
+#include <QtGlobal>
+
+// Separable triple box blur for 8-bit alpha masks. Three successive box passes
+// approximate a Gaussian; the vertical pass is vectorised with SSE2/AVX2 on x86-64
+// and picked at runtime, with a scalar fallback everywhere else.
+namespace BeautyBlur {
+
+enum class Backend {
+    Scalar,
+    Sse2,
+    Avx2
+};
+
+// Best backend supported by the running CPU.
+Backend bestBackend();
+Backend activeBackend();
+// Forces a backend, clamped to what the CPU supports. Mostly for comparisons.
+void setBackend(Backend backend);
+
+// Blurs the mask in place. Pixels outside the plane count as transparent.
+void blurAlpha(uchar *data, int width, int height, int stride, qreal sigma);
+
+// Sigma used for a shadow of the given blur radius, so that 3 sigma fit the padding.
+inline qreal sigmaForRadius(qreal radius) { return radius / 3.0; }
+
+} // namespace BeautyBlur
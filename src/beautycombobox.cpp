@@ -0,0 +1,410 @@
+#include "beautycombobox.h"
+#include "beautyanimationbudget.h"
+#include "beautypainter.h"
+#include "beautyshadow.h"
+#include "beautyshadoweffect.h"
+#include <QApplication>
+#include <QKeyEvent>
+#include <QListView>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QPainterPath>
+#include <QPropertyAnimation>
+#include <QProxyStyle>
+
+// Popup list for BeautyComboBox. Uniform rows and batched layout keep the view from
+// measuring every row, and keyboard search goes through the combo's lazy search.
+class BeautyComboPopupView : public QListView {
+public:
+    explicit BeautyComboPopupView(BeautyComboBox *combo)
+        : QListView(combo)
+        , m_combo(combo)
+    {
+        setUniformItemSizes(true);
+        setLayoutMode(QListView::Batched);
+        setBatchSize(256);
+        setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+    }
+
+    // QAbstractItemView measures every row of the model here; sample the first rows.
+    int sizeHintForColumn(int column) const override
+    {
+        const QAbstractItemModel *m = model();
+        if (!m) {
+            return -1;
+        }
+        const int rows = qMin(m->rowCount(rootIndex()), kSampleRows);
+        int width = -1;
+        for (int row = 0; row < rows; ++row) {
+            width = qMax(width, sizeHintForIndex(m->index(row, column, rootIndex())).width());
+        }
+        return width;
+    }
+
+    void keyboardSearch(const QString &search) override
+    {
+        m_combo->keyboardSearch(search);
+    }
+
+private:
+    BeautyComboBox *m_combo;
+    static constexpr int kSampleRows = 64;
+};
+
+// Styles with SH_ComboBox_Popup (Fusion, macOS) make QComboBox::showPopup() walk every
+// row of the model to size the popup and measure every item's text. The plain drop-down
+// list stops after maxVisibleItems rows.
+class BeautyComboStyle : public QProxyStyle {
+public:
+    int styleHint(StyleHint hint, const QStyleOption *option, const QWidget *widget,
+                  QStyleHintReturn *returnData) const override
+    {
+        if (hint == QStyle::SH_ComboBox_Popup) {
+            return 0;
+        }
+        return QProxyStyle::styleHint(hint, option, widget, returnData);
+    }
+};
+
+BeautyComboBox::BeautyComboBox(QWidget *parent)
+    : QComboBox(parent)
+{
+#ifdef Q_OS_MAC
+    setAttribute(Qt::WA_MacShowFocusRect, false);
+#endif
+    setAttribute(Qt::WA_Hover, true);
+    setMouseTracking(true);
+    setCursor(Qt::PointingHandCursor);
+    setAttribute(Qt::WA_TranslucentBackground, true);
+
+    m_shadow = new BeautyShadow(this);
+    m_shadow->setColor(QColor(0, 0, 0, 100));
+    setGraphicsEffect(new BeautyShadowEffect(m_shadow, this));
+
+    auto *style = new BeautyComboStyle;
+    style->setParent(this);
+    setStyle(style);
+
+    m_view = new BeautyComboPopupView(this);
+    setView(m_view);
+
+    // AdjustToContents would measure every item of the model.
+    setSizeAdjustPolicy(QComboBox::AdjustToMinimumContentsLengthWithIcon);
+    setMinimumContentsLength(12);
+    setMaxVisibleItems(12);
+    setScale(1);
+}
+
+void BeautyComboBox::setThemeColor(const QColor &base)
+{
+    m_normalColor  = base;
+    m_pressedColor = base.darker(120);
+    animateColor(restingColor());
+    update();
+}
+
+void BeautyComboBox::setDisabledColor(const QColor &c)
+{
+    m_disabledColor = c;
+    if (!isEnabled()) {
+        setBgColor(c);
+    }
+}
+
+void BeautyComboBox::setTextColor(const QColor &c)
+{
+    m_textColor = c;
+    update();
+}
+
+void BeautyComboBox::setBgColor(const QColor &c)
+{
+    m_bgColor = c;
+    update();
+}
+
+void BeautyComboBox::setScale(qreal s)
+{
+    m_scale = s;
+    syncShadowShape();
+    update();
+}
+
+QSize BeautyComboBox::sizeHint() const
+{
+    return QComboBox::sizeHint() + QSize(kMargin * 2, kMargin * 2);
+}
+
+QSize BeautyComboBox::minimumSizeHint() const
+{
+    return QComboBox::minimumSizeHint() + QSize(kMargin * 2, kMargin * 2);
+}
+
+QRectF BeautyComboBox::innerRect() const
+{
+    return QRectF(rect()).adjusted(kMargin, kMargin, -kMargin, -kMargin);
+}
+
+void BeautyComboBox::showPopup()
+{
+    // Only fetch what fills the popup; the view fetches the rest when it is scrolled to
+    // the bottom.
+    QAbstractItemModel *m = model();
+    const QModelIndex root = rootModelIndex();
+    while (m->rowCount(root) < maxVisibleItems() && m->canFetchMore(root)) {
+        const int before = m->rowCount(root);
+        m->fetchMore(root);
+        if (m->rowCount(root) == before) {
+            break;
+        }
+    }
+
+    m_popupVisible = true;
+    m_searchPrefix.clear();
+    syncShadowState();
+    QComboBox::showPopup();
+}
+
+void BeautyComboBox::hidePopup()
+{
+    QComboBox::hidePopup();
+    m_popupVisible = false;
+    m_searchPrefix.clear();
+    animateScale(underMouse() ? 1.01 : 1.0);
+    syncShadowState();
+    update();
+}
+
+void BeautyComboBox::keyboardSearch(const QString &search)
+{
+    if (search.isEmpty()) {
+        return;
+    }
+    if (!m_searchTimer.isValid() || m_searchTimer.elapsed() > QApplication::keyboardInputInterval()) {
+        m_searchPrefix.clear();
+    }
+    m_searchTimer.start();
+    m_searchPrefix += search;
+
+    QAbstractItemModel *m = model();
+    const QModelIndex root = rootModelIndex();
+    const int column = modelColumn();
+    const int current = m_popupVisible ? m_view->currentIndex().row() : currentIndex();
+    // A fresh single letter moves on to the next match, a longer prefix refines the
+    // current one.
+    const int start = qMax(0, current + (m_searchPrefix.size() == 1 ? 1 : 0));
+
+    auto matches = [&](int row) {
+        return m->index(row, column, root).data(Qt::DisplayRole).toString()
+            .startsWith(m_searchPrefix, Qt::CaseInsensitive);
+    };
+
+    int row = start;
+    int fetches = 0;
+    for (;;) {
+        const int rows = m->rowCount(root);
+        for (; row < rows; ++row) {
+            if (matches(row)) {
+                selectSearchResult(row);
+                return;
+            }
+        }
+        if (fetches >= kSearchFetchLimit || !m->canFetchMore(root)) {
+            break;
+        }
+        m->fetchMore(root);
+        ++fetches;
+        if (m->rowCount(root) == rows) {
+            break;
+        }
+    }
+
+    const int wrapEnd = qMin(start, m->rowCount(root));
+    for (row = 0; row < wrapEnd; ++row) {
+        if (matches(row)) {
+            selectSearchResult(row);
+            return;
+        }
+    }
+}
+
+void BeautyComboBox::selectSearchResult(int row)
+{
+    if (m_popupVisible) {
+        const QModelIndex index = model()->index(row, modelColumn(), rootModelIndex());
+        m_view->setCurrentIndex(index);
+        m_view->scrollTo(index);
+    } else {
+        setCurrentIndex(row);
+    }
+}
+
+void BeautyComboBox::keyPressEvent(QKeyEvent *event)
+{
+    const QString text = event->text();
+    const bool plain = !(event->modifiers() & (Qt::ControlModifier | Qt::AltModifier | Qt::MetaModifier));
+    // An editable combo gets the keys of its line edit, its focus proxy; let them through.
+    if (!isEditable() && plain && !text.isEmpty() && text.at(0).isPrint() && !text.at(0).isSpace()) {
+        keyboardSearch(text);
+        event->accept();
+        return;
+    }
+    QComboBox::keyPressEvent(event);
+}
+
+void BeautyComboBox::changeEvent(QEvent *event)
+{
+    QComboBox::changeEvent(event);
+    if (event->type() != QEvent::EnabledChange) {
+        return;
+    }
+    if (!isEnabled()) {
+        BeautyAnimationBudget::instance().stopAll(this);
+        setCursor(Qt::ArrowCursor);
+        setScale(1.0);
+        setBgColor(m_disabledColor);
+        m_shadow->setBlurRadius(0);
+        m_shadow->setOffset(0, 0);
+        return;
+    }
+    setCursor(Qt::PointingHandCursor);
+    animateColor(m_normalColor);
+    syncShadowState();
+}
+
+void BeautyComboBox::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+    QPainter p(this);
+    p.setRenderHint(QPainter::Antialiasing, true);
+
+    const QRectF r = innerRect();
+    BeautyPainter::applyFloatTransform(&p, r, m_scale, QPointF(0, 0));
+    BeautyPainter::drawBody(&p, r, kCornerRadius, m_bgColor, isRestingColor(m_bgColor),
+                            devicePixelRatioF());
+
+    QColor textColor = m_textColor;
+    if (!isEnabled()) {
+        textColor.setAlphaF(qBound(0.0, textColor.alphaF() * 0.6, 1.0));
+    }
+
+    const QRectF textRect = r.adjusted(10, 0, -kArrowWidth, 0);
+    const QString label = fontMetrics().elidedText(currentText(), Qt::ElideRight, int(textRect.width()));
+    p.setPen(textColor);
+    p.setFont(font());
+    p.drawText(textRect, Qt::AlignVCenter | Qt::AlignLeft, label);
+
+    const QPointF c(r.right() - kArrowWidth / 2.0, r.center().y());
+    const qreal dy = m_popupVisible ? -2.0 : 2.0;
+    QPainterPath chevron;
+    chevron.moveTo(c + QPointF(-4, -dy));
+    chevron.lineTo(c + QPointF(0, dy));
+    chevron.lineTo(c + QPointF(4, -dy));
+    p.setPen(QPen(textColor, 1.5, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin));
+    p.setBrush(Qt::NoBrush);
+    p.drawPath(chevron);
+}
+
+void BeautyComboBox::enterEvent(QEnterEvent *event)
+{
+    if (!isEnabled()) {
+        event->ignore();
+        return;
+    }
+    animateScale(1.01);
+    syncShadowState();
+    QComboBox::enterEvent(event);
+}
+
+void BeautyComboBox::leaveEvent(QEvent *event)
+{
+    if (!isEnabled()) {
+        event->ignore();
+        return;
+    }
+    animateScale(1.0);
+    syncShadowState();
+    QComboBox::leaveEvent(event);
+}
+
+void BeautyComboBox::mousePressEvent(QMouseEvent *event)
+{
+    if (!isEnabled()) {
+        event->ignore();
+        return;
+    }
+    animateColor(m_pressedColor);
+    animateScale(0.95);
+    QComboBox::mousePressEvent(event);
+}
+
+void BeautyComboBox::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (!isEnabled()) {
+        event->ignore();
+        return;
+    }
+    QComboBox::mouseReleaseEvent(event);
+    animateScale(underMouse() ? 1.01 : 1.0);
+    animateColor(m_normalColor);
+}
+
+void BeautyComboBox::animateColor(const QColor &to)
+{
+    auto *anim = new QPropertyAnimation(this, "bgColor", this);
+    anim->setDuration(150);
+    anim->setStartValue(m_bgColor);
+    anim->setEndValue(to);
+    anim->setEasingCurve(QEasingCurve::OutCubic);
+    BeautyAnimationBudget::instance().start(anim, this);
+}
+
+void BeautyComboBox::animateScale(qreal to)
+{
+    auto *anim = new QPropertyAnimation(this, "scale", this);
+    anim->setDuration(150);
+    anim->setStartValue(m_scale);
+    anim->setEndValue(to);
+    anim->setEasingCurve(QEasingCurve::OutCubic);
+    BeautyAnimationBudget::instance().start(anim, this);
+}
+
+void BeautyComboBox::animateShadow(qreal blurRadius, const QPointF &offset)
+{
+    auto *blur = new QPropertyAnimation(m_shadow, "blurRadius", this);
+    blur->setDuration(150);
+    blur->setStartValue(m_shadow->blurRadius());
+    blur->setEndValue(blurRadius);
+    blur->setEasingCurve(QEasingCurve::OutCubic);
+    BeautyAnimationBudget::instance().start(blur, this);
+
+    auto *offsetAnim = new QPropertyAnimation(m_shadow, "offset", this);
+    offsetAnim->setDuration(150);
+    offsetAnim->setStartValue(m_shadow->offset());
+    offsetAnim->setEndValue(offset);
+    offsetAnim->setEasingCurve(QEasingCurve::OutCubic);
+    BeautyAnimationBudget::instance().start(offsetAnim, this);
+}
+
+void BeautyComboBox::syncShadowState()
+{
+    syncShadowShape();
+    const bool shouldFloat = isEnabled() && (underMouse() || m_popupVisible);
+    animateShadow(shouldFloat ? 30.0 : 0.0, shouldFloat ? QPointF(0, 3) : QPointF(0, 0));
+}
+
+void BeautyComboBox::syncShadowShape()
+{
+    m_shadow->setShape(innerRect(), kCornerRadius);
+    m_shadow->setShapeTransform(m_scale, QPointF(0, 0));
+}
+
+bool BeautyComboBox::isRestingColor(const QColor &c) const
+{
+    return c == m_normalColor || c == m_pressedColor || c == m_disabledColor;
+}
+
+QColor BeautyComboBox::restingColor() const
+{
+    return isEnabled() ? m_normalColor : m_disabledColor;
+}
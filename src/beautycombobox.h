@@ -0,0 +1,81 @@
+#pragma once
+#include <QComboBox>
+#include <QColor>
+#include <QElapsedTimer>
+#include <QPointF>
+#include <QString>
+
+class BeautyComboPopupView;
+class BeautyShadow;
+
+// Combo box in the BeautyPushButton style. The popup is a virtualised list with
+// uniform rows that pulls rows lazily through canFetchMore()/fetchMore(), so opening
+// it does not depend on the model size.
+class BeautyComboBox : public QComboBox {
+    Q_OBJECT
+    Q_PROPERTY(QColor  bgColor READ bgColor WRITE setBgColor)
+    Q_PROPERTY(qreal   scale  READ scale    WRITE setScale)
+
+public:
+    explicit BeautyComboBox(QWidget *parent = nullptr);
+
+    void setThemeColor(const QColor &base);
+    void setDisabledColor(const QColor &c);
+    void setTextColor(const QColor &c);
+    QColor bgColor() const { return m_bgColor; }
+    void   setBgColor(const QColor &c);
+
+    // Incremental prefix search over the model, fetching more rows when it runs off
+    // the loaded ones. Consecutive calls within the keyboard input interval extend
+    // the prefix.
+    void keyboardSearch(const QString &search);
+
+    void showPopup() override;
+    void hidePopup() override;
+    QSize sizeHint() const override;
+    QSize minimumSizeHint() const override;
+
+private:
+    qreal   scale()  const { return m_scale; }
+    void    setScale(qreal s);
+
+protected:
+    void changeEvent(QEvent *event) override;
+    void paintEvent(QPaintEvent *event) override;
+    void enterEvent(QEnterEvent *event) override;
+    void leaveEvent(QEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    void keyPressEvent(QKeyEvent *event) override;
+
+private:
+    void animateColor(const QColor &to);
+    void animateScale(qreal to);
+    void animateShadow(qreal blurRadius, const QPointF &offset);
+    void syncShadowState();
+    void syncShadowShape();
+    bool isRestingColor(const QColor &c) const;
+    QColor restingColor() const;
+    void selectSearchResult(int row);
+
+    QRectF innerRect() const;
+
+private:
+    QColor  m_bgColor { 210, 245, 210 };
+    qreal   m_scale   { 1.0 };
+    QColor  m_normalColor { m_bgColor };
+    QColor  m_pressedColor { m_normalColor.darker(120) };
+    QColor  m_disabledColor { "#808080" };
+    QColor  m_textColor { Qt::black };
+    bool    m_popupVisible { false };
+
+    BeautyShadow *m_shadow { nullptr };
+    BeautyComboPopupView *m_view { nullptr };
+    QString m_searchPrefix;
+    QElapsedTimer m_searchTimer;
+
+    static constexpr int kMargin = 6;
+    static constexpr qreal kCornerRadius = 8;
+    static constexpr int kArrowWidth = 22;
+    static constexpr int kSearchFetchLimit = 64;
+};
@@ -0,0 +1,36 @@
+#include "beautyiconcache.h"
+#include <QPainter>
+
+BeautyIconCache &BeautyIconCache::instance()
+{
+    static BeautyIconCache cache;
+    return cache;
+}
+
+BeautyIconCache::BeautyIconCache()
+{
+    m_cache.setMaxCost(4 * 1024 * 1024);
+}
+
+QPixmap BeautyIconCache::tinted(const QIcon &icon, const QSize &size, const QColor &color, qreal dpr)
+{
+    if (icon.isNull() || size.isEmpty()) {
+        return QPixmap();
+    }
+
+    const Key key { icon.cacheKey(), size, color.rgba(), quint16(qBound(1, qRound(dpr * 100.0), 65535)) };
+    if (const QPixmap *cached = m_cache.object(key)) {
+        return *cached;
+    }
+
+    QImage image = icon.pixmap(size, dpr).toImage().convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    {
+        QPainter p(&image);
+        p.setCompositionMode(QPainter::CompositionMode_SourceIn);
+        p.fillRect(image.rect(), color);
+    }
+    QPixmap pixmap = QPixmap::fromImage(std::move(image));
+    pixmap.setDevicePixelRatio(dpr);
+    m_cache.insert(key, new QPixmap(pixmap), qint64(pixmap.width()) * pixmap.height() * 4);
+    return pixmap;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <QCache>
+#include <QColor>
+#include <QHashFunctions>
+#include <QIcon>
+#include <QPixmap>
+#include <QSize>
+
+// Shared cache of recoloured icon pixmaps, keyed by (icon cache key, size, colour,
+// device pixel ratio), so buttons never recolour an icon while painting a frame.
+class BeautyIconCache {
+public:
+    static BeautyIconCache &instance();
+
+    // The icon's alpha filled with color, at size logical pixels for the given ratio.
+    QPixmap tinted(const QIcon &icon, const QSize &size, const QColor &color, qreal dpr);
+
+    void clear() { m_cache.clear(); }
+    void setMaxBytes(qint64 bytes) { m_cache.setMaxCost(qMax<qint64>(0, bytes)); }
+    qint64 bytesUsed() const { return m_cache.totalCost(); }
+
+private:
+    struct Key {
+        qint64  icon { 0 };
+        QSize   size;
+        QRgb    color { 0 };
+        quint16 dpr { 100 }; // percent
+
+        friend bool operator==(const Key &a, const Key &b) {
+            return a.icon == b.icon && a.size == b.size && a.color == b.color && a.dpr == b.dpr;
+        }
+        friend size_t qHash(const Key &k, size_t seed = 0) {
+            return qHashMulti(seed, k.icon, k.size.width(), k.size.height(), k.color, k.dpr);
+        }
+    };
+
+    BeautyIconCache();
+
+    QCache<Key, QPixmap> m_cache;
+};
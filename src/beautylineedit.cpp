@@ -1,13 +1,29 @@
 #include "BeautyLineEdit.h"
+#include "beautyanimationbudget.h"
+#include "beautypainter.h"
+#include "beautyshadow.h"
+#include "beautyshadoweffect.h"
+#include "beautysnapshot.h"
+#include <QHashFunctions>
 #include <QPainter>
 #include <QPainterPath>
-#include <QGraphicsDropShadowEffect>
 #include <QPropertyAnimation>
 #include <QMouseEvent>
 #include <QEvent>
+#include <QAbstractItemView>
+#include <QCompleter>
+#include <QCoreApplication>
+#include <QPointer>
+#include <QStringListModel>
+#include <QThread>
+#include <QThreadPool>
+#include <QTimer>
 
 BeautyLineEdit::BeautyLineEdit(QWidget *parent)
     : QLineEdit(parent)
+    , m_shadow(new BeautyShadow(this))
+    , m_snapshot(new BeautySnapshot(this))
+    , m_opaque(this, m_shadow, m_snapshot)
 {
 #ifdef Q_OS_MAC
     setAttribute(Qt::WA_MacShowFocusRect, false);
@@ -16,35 +32,33 @@ BeautyLineEdit::BeautyLineEdit(QWidget *parent)
     setMouseTracking(true);
     setAttribute(Qt::WA_TranslucentBackground, true);
 
-    auto *shadow = new QGraphicsDropShadowEffect(this);
-    shadow->setBlurRadius(0);
-    shadow->setOffset(0, 0);
-    shadow->setColor(QColor(0,0,0,60));
-    setGraphicsEffect(shadow);
+    m_shadow->setColor(QColor(0,0,0,60));
+    setGraphicsEffect(new BeautyShadowEffect(m_shadow, this));
     setFrame(false);
 
     setMinimumHeight(40);
-    setStyleSheet(QStringLiteral(
-        "QLineEdit { background: transparent; border: none; padding-left: %1px; padding-right: %1px; padding-top: 0px; padding-bottom: 0px; }")
-                      .arg(kMargin + 6 + width() * 0.01));
+    syncPadding();
     setThemeColor(QColor("#003494"));
     setScale(kRestScale);
 
+    m_settleTimer = new QTimer(this);
+    m_settleTimer->setSingleShot(true);
+    m_settleTimer->setInterval(m_settleDelay);
+    connect(m_settleTimer, &QTimer::timeout, this, &BeautyLineEdit::settle);
+    connect(this, &QLineEdit::textChanged, this, &BeautyLineEdit::onTextChanged);
+    connect(this, &QLineEdit::textEdited, this, &BeautyLineEdit::dropCompletions);
 }
 
-static QColor mixWithWhite(const QColor &c, qreal factor) {
-    return QColor::fromRgbF(
-        c.redF()   * (1.0 - factor) + 1.0 * factor,
-        c.greenF() * (1.0 - factor) + 1.0 * factor,
-        c.blueF()  * (1.0 - factor) + 1.0 * factor,
-        1.0
-        );
+BeautyLineEdit::~BeautyLineEdit()
+{
+    // Cancels whatever is still running on the worker threads.
+    m_generation->fetch_add(1, std::memory_order_relaxed);
 }
 
 void BeautyLineEdit::setThemeColor(const QColor &c) {
     m_themeColor  = c;
-    m_normalColor = mixWithWhite(c, 0.96);
-    m_activeColor = mixWithWhite(c, 0.99);
+    m_normalColor = BeautyPainter::mixWithWhite(c, 0.96);
+    m_activeColor = BeautyPainter::mixWithWhite(c, 0.99);
     QColor target = m_disabledColor;
     if (isEnabled()) {
         target = hasFocus() ? m_activeColor : m_normalColor;
@@ -63,7 +77,7 @@ void BeautyLineEdit::setThemeColor(const QColor &c) {
         back->setStartValue(m_offset);
         back->setEndValue(QPointF(0, 0));
         back->setEasingCurve(QEasingCurve::OutCubic);
-        back->start(QAbstractAnimation::DeleteWhenStopped);
+        BeautyAnimationBudget::instance().start(back, this);
     }
 }
 
@@ -91,6 +105,7 @@ void BeautyLineEdit::setBgColor(const QColor &c) {
 
 void BeautyLineEdit::setScale(qreal s) {
     m_scale = s;
+    syncShadowShape();
     update();
 }
 
@@ -102,35 +117,20 @@ void BeautyLineEdit::changeEvent(QEvent *event)
         return;
     }
 
+    m_snapshot->syncEnabled();
     if (!isEnabled()) {
         m_savedFocusPolicy = focusPolicy();
 
         setFocusPolicy(Qt::NoFocus);
         clearFocus();
-        const auto anims = findChildren<QAbstractAnimation*>();
-        for (auto *a : anims) {
-            if (a) a->stop();
-        }
+        BeautyAnimationBudget::instance().stopAll(this);
         setCursor(Qt::ArrowCursor);
         setOffset(QPointF(0, 0));
         setScale(kRestScale);
         setBgColor(m_disabledColor);
 
-        if (auto *shadow = qobject_cast<QGraphicsDropShadowEffect*>(graphicsEffect())) {
-            auto *blur = new QPropertyAnimation(shadow, "blurRadius", this);
-            blur->setDuration(150);
-            blur->setStartValue(shadow->blurRadius());
-            blur->setEndValue(0);
-            blur->setEasingCurve(QEasingCurve::OutCubic);
-            blur->start(QAbstractAnimation::DeleteWhenStopped);
-
-            auto *offsetAnim = new QPropertyAnimation(shadow, "offset", this);
-            offsetAnim->setDuration(150);
-            offsetAnim->setStartValue(shadow->offset());
-            offsetAnim->setEndValue(QPointF(0, 0));
-            offsetAnim->setEasingCurve(QEasingCurve::OutCubic);
-            offsetAnim->start(QAbstractAnimation::DeleteWhenStopped);
-        }
+        m_shadow->setBlurRadius(0);
+        m_shadow->setOffset(0, 0);
         return;
     }
 
@@ -156,6 +156,37 @@ QRectF BeautyLineEdit::innerRect() const
     return QRectF(rect()).adjusted(kMargin, kMargin, -kMargin, -kMargin);
 }
 
+void BeautyLineEdit::resizeEvent(QResizeEvent *event)
+{
+    QLineEdit::resizeEvent(event);
+    syncShadowShape();
+    syncPadding();
+}
+
+// Re-applying the style sheet repolishes the widget, so only do it when the padding
+// actually changes instead of on every paint.
+void BeautyLineEdit::syncPadding()
+{
+    const QString sheet = QStringLiteral(
+        "QLineEdit { background: transparent; border: none; padding-left: %1px; padding-right: %1px; padding-top: 0px; padding-bottom: 0px; }")
+                              .arg(kMargin + 6 + width() * 0.01);
+    if (sheet != styleSheet()) {
+        setStyleSheet(sheet);
+    }
+}
+
+void BeautyLineEdit::syncShadowShape()
+{
+    const QRectF r = innerRect();
+    m_shadow->setShape(r, r.height() / 2.0);
+    m_shadow->setShapeTransform(m_scale, m_offset);
+}
+
+bool BeautyLineEdit::isRestingColor(const QColor &c) const
+{
+    return c == m_normalColor || c == m_activeColor || c == m_disabledColor;
+}
+
 void BeautyLineEdit::setOffset(const QPointF &o)
 {
     const QPointF clamped(qBound(-3.0, o.x(), 3.0),
@@ -165,38 +196,39 @@ void BeautyLineEdit::setOffset(const QPointF &o)
         return;
 
     m_offset = clamped;
+    syncShadowShape();
     update();
 }
 
 void BeautyLineEdit::paintEvent(QPaintEvent *event)
 {
+    if (m_snapshot->paint([this] { return snapshotKey(); })) {
+        return;
+    }
+
     QPainter p(this);
     p.setRenderHint(QPainter::Antialiasing);
+    if (m_opaque.isEnabled()) {
+        m_opaque.paint(&p);
+    }
 
     const QRectF r = innerRect();
     const qreal radius = r.height() / 2.0;
 
     p.save();
-    p.translate(m_offset);
-    p.translate(r.center());
-    p.scale(m_scale, m_scale);
-    p.translate(-r.center());
-
-    p.setBrush(m_bgColor);
-    p.setPen(Qt::NoPen);
-    p.drawRoundedRect(r, radius, radius);
+    BeautyPainter::applyFloatTransform(&p, r, m_scale, m_offset);
+    BeautyPainter::drawBody(&p, r, radius, m_bgColor, isRestingColor(m_bgColor), devicePixelRatioF());
 
     const qreal outlineW = hasFocus() ? 2 : 0.8;
-    QPen outline(isEnabled()? m_themeColor : m_disabledColor, outlineW);
+    QPen outline(outlineColor(), outlineW);
+    if (isEnabled() && m_validationState == ValidationState::Pending) {
+        outline.setStyle(Qt::DashLine);
+    }
     p.setBrush(Qt::NoBrush);
     p.setPen(outline);
     p.drawRoundedRect(r, radius, radius);
     p.restore();
 
-    setStyleSheet(QStringLiteral(
-                    "QLineEdit { background: transparent; border: none; padding-left: %1px; padding-right: %1px; padding-top: 0px; padding-bottom: 0px; }")
-                    .arg(kMargin + 6 + width() * 0.01));
-
     QLineEdit::paintEvent(event);
 }
 
@@ -206,24 +238,11 @@ void BeautyLineEdit::focusInEvent(QFocusEvent *event)
         QLineEdit::focusInEvent(event);
         return;
     }
+    m_snapshot->wake();
     animateColor(m_activeColor);
     animateScale(kFocusScale);
 
-    if (auto *shadow = qobject_cast<QGraphicsDropShadowEffect*>(graphicsEffect())) {
-        auto *blur = new QPropertyAnimation(shadow, "blurRadius");
-        blur->setDuration(150);
-        blur->setStartValue(shadow->blurRadius());
-        blur->setEndValue(30);   // ← 按钮的模糊半径
-        blur->setEasingCurve(QEasingCurve::OutCubic);
-        blur->start(QAbstractAnimation::DeleteWhenStopped);
-
-        auto *offsetAnim = new QPropertyAnimation(shadow, "offset");
-        offsetAnim->setDuration(150);
-        offsetAnim->setStartValue(shadow->offset());
-        offsetAnim->setEndValue(QPointF(0, 3));
-        offsetAnim->setEasingCurve(QEasingCurve::OutCubic);
-        offsetAnim->start(QAbstractAnimation::DeleteWhenStopped);
-    }
+    animateShadow(30, QPointF(0, 3));   // ← 按钮的模糊半径
 
     QLineEdit::focusInEvent(event);
 }
@@ -237,21 +256,7 @@ void BeautyLineEdit::focusOutEvent(QFocusEvent *event)
     animateColor(m_normalColor);
     animateScale(underMouse() ? kFocusScale : kRestScale);
 
-    if (auto *shadow = qobject_cast<QGraphicsDropShadowEffect*>(graphicsEffect())) {
-        auto *blur = new QPropertyAnimation(shadow, "blurRadius");
-        blur->setDuration(150);
-        blur->setStartValue(shadow->blurRadius());
-        blur->setEndValue(0);
-        blur->setEasingCurve(QEasingCurve::OutCubic);
-        blur->start(QAbstractAnimation::DeleteWhenStopped);
-
-        auto *offsetAnim = new QPropertyAnimation(shadow, "offset");
-        offsetAnim->setDuration(150);
-        offsetAnim->setStartValue(shadow->offset());
-        offsetAnim->setEndValue(QPointF(0, 0));
-        offsetAnim->setEasingCurve(QEasingCurve::OutCubic);
-        offsetAnim->start(QAbstractAnimation::DeleteWhenStopped);
-    }
+    animateShadow(0, QPointF(0, 0));
 
     QLineEdit::focusOutEvent(event);
 }
@@ -287,6 +292,7 @@ void BeautyLineEdit::enterEvent(QEnterEvent *event)
         event->ignore();
         return;
     }
+    m_snapshot->wake();
     if (!hasFocus()) {
         animateScale(kFocusScale);
     }
@@ -306,7 +312,7 @@ void BeautyLineEdit::leaveEvent(QEvent *event)
         back->setStartValue(m_offset);
         back->setEndValue(QPointF(0,0));
         back->setEasingCurve(QEasingCurve::OutCubic);
-        back->start(QAbstractAnimation::DeleteWhenStopped);
+        BeautyAnimationBudget::instance().start(back, this);
     }else{
         animateScale(kRestScale);
     }
@@ -321,7 +327,7 @@ void BeautyLineEdit::animateColor(const QColor &to)
     anim->setStartValue(m_bgColor);
     anim->setEndValue(to);
     anim->setEasingCurve(QEasingCurve::OutCubic);
-    anim->start(QAbstractAnimation::DeleteWhenStopped);
+    BeautyAnimationBudget::instance().start(anim, this);
 }
 
 void BeautyLineEdit::animateScale(qreal to)
@@ -331,5 +337,201 @@ void BeautyLineEdit::animateScale(qreal to)
     anim->setStartValue(m_scale);
     anim->setEndValue(to);
     anim->setEasingCurve(QEasingCurve::OutCubic);
-    anim->start(QAbstractAnimation::DeleteWhenStopped);
+    BeautyAnimationBudget::instance().start(anim, this);
+}
+
+void BeautyLineEdit::animateShadow(qreal blurRadius, const QPointF &offset)
+{
+    auto *blur = new QPropertyAnimation(m_shadow, "blurRadius");
+    blur->setDuration(150);
+    blur->setStartValue(m_shadow->blurRadius());
+    blur->setEndValue(blurRadius);
+    blur->setEasingCurve(QEasingCurve::OutCubic);
+    BeautyAnimationBudget::instance().start(blur, this);
+
+    auto *offsetAnim = new QPropertyAnimation(m_shadow, "offset");
+    offsetAnim->setDuration(150);
+    offsetAnim->setStartValue(m_shadow->offset());
+    offsetAnim->setEndValue(offset);
+    offsetAnim->setEasingCurve(QEasingCurve::OutCubic);
+    BeautyAnimationBudget::instance().start(offsetAnim, this);
+}
+
+QColor BeautyLineEdit::outlineColor() const
+{
+    if (!isEnabled()) {
+        return m_disabledColor;
+    }
+    switch (m_validationState) {
+    case ValidationState::Valid:
+        return m_validColor;
+    case ValidationState::Invalid:
+        return m_invalidColor;
+    default:
+        return m_themeColor;
+    }
+}
+
+// Everything paintEvent depends on besides size and device pixel ratio.
+size_t BeautyLineEdit::snapshotKey() const
+{
+    return qHashMulti(0, text(), placeholderText(), int(echoMode()), int(alignment()),
+                      cursorPosition(), selectionStart(), selectionLength(), hasFocus(),
+                      isEnabled(), m_bgColor.rgba(), outlineColor().rgba(), int(m_validationState),
+                      m_scale, m_offset.x(), m_offset.y(), m_opaque.color().rgba(),
+                      m_shadow->blurRadius(), m_shadow->offset().x(), m_shadow->offset().y(),
+                      palette().cacheKey(), font().key());
+}
+
+void BeautyLineEdit::setOpaqueBackground(const QColor &color)
+{
+    m_opaque.setColor(color);
+}
+
+void BeautyLineEdit::setSettleDelay(int ms)
+{
+    m_settleDelay = qMax(0, ms);
+    m_settleTimer->setInterval(m_settleDelay);
+}
+
+void BeautyLineEdit::setAsyncValidator(std::shared_ptr<BeautyAsyncValidator> validator)
+{
+    m_validator = std::move(validator);
+    m_generation->fetch_add(1, std::memory_order_relaxed);
+    if (!m_validator) {
+        setValidationState(ValidationState::None);
+        return;
+    }
+    setValidationState(ValidationState::Pending);
+    m_settleTimer->start();
+}
+
+void BeautyLineEdit::setAsyncCompleter(std::shared_ptr<BeautyAsyncCompleter> completer)
+{
+    m_completer = std::move(completer);
+    // The bump also cancels a validation in flight, so run both again once settled.
+    m_generation->fetch_add(1, std::memory_order_relaxed);
+    if (m_validator || m_completer) {
+        m_settleTimer->start();
+    }
+}
+
+void BeautyLineEdit::setValidationColors(const QColor &valid, const QColor &invalid)
+{
+    m_validColor = valid;
+    m_invalidColor = invalid;
+    update();
+}
+
+void BeautyLineEdit::onTextChanged()
+{
+    m_generation->fetch_add(1, std::memory_order_relaxed);
+    if (m_validator) {
+        setValidationState(ValidationState::Pending);
+    }
+    m_settleTimer->start();
+}
+
+void BeautyLineEdit::settle()
+{
+    const QString current = text();
+    emit textSettled(current);
+
+    if (!m_validator && !m_completer) {
+        return;
+    }
+
+    const BeautyCancelToken token(m_generation, m_generation->load(std::memory_order_relaxed));
+    const QPointer<BeautyLineEdit> self(this);
+
+    if (auto validator = m_validator) {
+        workerPool()->start([validator, current, token, self] {
+            if (token.isCanceled()) {
+                return;
+            }
+            const bool valid = validator->validate(current, token);
+            if (token.isCanceled()) {
+                return;
+            }
+            QMetaObject::invokeMethod(QCoreApplication::instance(), [self, token, valid] {
+                if (self && !token.isCanceled()) {
+                    self->setValidationState(valid ? ValidationState::Valid : ValidationState::Invalid);
+                }
+            }, Qt::QueuedConnection);
+        });
+    }
+
+    if (auto completer = m_completer) {
+        workerPool()->start([completer, current, token, self] {
+            if (token.isCanceled()) {
+                return;
+            }
+            QStringList completions = completer->complete(current, token);
+            if (token.isCanceled()) {
+                return;
+            }
+            QMetaObject::invokeMethod(QCoreApplication::instance(),
+                                      [self, token, completions = std::move(completions)] {
+                if (self && !token.isCanceled()) {
+                    self->applyCompletions(completions);
+                }
+            }, Qt::QueuedConnection);
+        });
+    }
+}
+
+void BeautyLineEdit::setValidationState(ValidationState state)
+{
+    if (m_validationState == state) {
+        return;
+    }
+    m_validationState = state;
+    update();
+    emit validationStateChanged(state);
+}
+
+// Typing makes the last list stale. QLineEdit completes again right after textEdited,
+// and an empty model hides the popup instead of showing old rows for the new text.
+void BeautyLineEdit::dropCompletions()
+{
+    if (m_completionModel) {
+        m_completionModel->setStringList(QStringList());
+    }
+    if (m_completionPopup && m_completionPopup->popup()) {
+        m_completionPopup->popup()->hide();
+    }
+}
+
+void BeautyLineEdit::applyCompletions(const QStringList &completions)
+{
+    // A completer installed by the user is left alone; completionsReady() still fires.
+    if (!m_completionPopup && !completer()) {
+        m_completionModel = new QStringListModel(this);
+        m_completionPopup = new QCompleter(m_completionModel, this);
+        // The list is already filtered on the worker, do not filter it again here.
+        m_completionPopup->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+        auto remember = [this](const QString &completion) { m_acceptedCompletion = completion; };
+        connect(m_completionPopup, qOverload<const QString &>(&QCompleter::activated), this, remember);
+        connect(m_completionPopup, qOverload<const QString &>(&QCompleter::highlighted), this, remember);
+        setCompleter(m_completionPopup);
+    }
+    // Text set from the popup settles too; that must not reopen it.
+    if (m_completionPopup && completer() == m_completionPopup && text() != m_acceptedCompletion) {
+        m_completionModel->setStringList(completions);
+        if (hasFocus() && !completions.isEmpty()) {
+            m_completionPopup->complete();
+        }
+    }
+    emit completionsReady(completions);
+}
+
+QThreadPool *BeautyLineEdit::workerPool()
+{
+    static QThreadPool pool;
+    static const bool configured = [] {
+        pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() / 2));
+        return true;
+    }();
+    Q_UNUSED(configured);
+    return &pool;
 }
@@ -2,24 +2,68 @@
 
 #include <QLineEdit>
 #include <QColor>
+#include <QPointer>
 #include <QPointF>
 #include <QRectF>
 #include <QSize>
+#include <QStringList>
+
+#include <atomic>
+#include <memory>
+
+#include "beautyasyncvalidator.h"
+#include "beautyopaquebackground.h"
+
+class BeautyShadow;
+class BeautySnapshot;
+class QCompleter;
+class QStringListModel;
+class QThreadPool;
+class QTimer;
 
 class BeautyLineEdit : public QLineEdit {
     Q_OBJECT
     Q_PROPERTY(QColor  bgColor READ bgColor WRITE setBgColor)
     Q_PROPERTY(qreal   scale   READ scale   WRITE setScale)
     Q_PROPERTY(QPointF offset  READ offset  WRITE setOffset)
+    Q_PROPERTY(int     settleDelay READ settleDelay WRITE setSettleDelay)
 
 public:
+    enum class ValidationState {
+        None,
+        Pending,
+        Valid,
+        Invalid
+    };
+    Q_ENUM(ValidationState)
+
     explicit BeautyLineEdit(QWidget *parent = nullptr);
+    ~BeautyLineEdit() override;
 
     void setThemeColor(const QColor &c);
     void setDisabledColor(const QColor &c);
     void setTextColor(const QColor &c);
     QSize sizeHint() const override;
 
+    // textSettled() fires once typing pauses for settleDelay milliseconds; the async
+    // validator and completer run on a worker thread after that, and stale runs are
+    // canceled as soon as the text changes again.
+    int  settleDelay() const { return m_settleDelay; }
+    void setSettleDelay(int ms);
+    void setAsyncValidator(std::shared_ptr<BeautyAsyncValidator> validator);
+    void setAsyncCompleter(std::shared_ptr<BeautyAsyncCompleter> completer);
+    ValidationState validationState() const { return m_validationState; }
+    void setValidationColors(const QColor &valid, const QColor &invalid);
+
+    // See BeautyOpaqueBackground.
+    void    setOpaqueBackground(const QColor &color);
+    QColor  opaqueBackground() const { return m_opaque.color(); }
+
+signals:
+    void textSettled(const QString &text);
+    void validationStateChanged(BeautyLineEdit::ValidationState state);
+    void completionsReady(const QStringList &completions);
+
 private:
     QColor  bgColor() const { return m_bgColor; }
     void    setBgColor(const QColor &c);
@@ -30,6 +74,7 @@ private:
 
 protected:
     void changeEvent(QEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
     void paintEvent(QPaintEvent *event) override;
     void focusInEvent(QFocusEvent *event) override;
     void focusOutEvent(QFocusEvent *event) override;
@@ -40,6 +85,19 @@ protected:
 private:
     void animateColor(const QColor &to);
     void animateScale(qreal to);
+    void animateShadow(qreal blurRadius, const QPointF &offset);
+    void syncShadowShape();
+    void syncPadding();
+    bool isRestingColor(const QColor &c) const;
+    QColor outlineColor() const;
+    size_t snapshotKey() const;
+
+    void onTextChanged();
+    void dropCompletions();
+    void settle();
+    void setValidationState(ValidationState state);
+    void applyCompletions(const QStringList &completions);
+    static QThreadPool *workerPool();
 
     QRectF innerRect() const;
 
@@ -52,6 +110,21 @@ private:
     qreal   m_scale   { 0.5 };
     QPointF m_offset  { 0, 0 };
     Qt::FocusPolicy m_savedFocusPolicy { Qt::StrongFocus };
+    QColor  m_validColor { QColor("#2e9d57") };
+    QColor  m_invalidColor { QColor("#d64545") };
+
+    QTimer *m_settleTimer { nullptr };
+    int     m_settleDelay { 250 };
+    std::shared_ptr<BeautyAsyncValidator> m_validator;
+    std::shared_ptr<BeautyAsyncCompleter> m_completer;
+    std::shared_ptr<std::atomic<quint64>> m_generation { std::make_shared<std::atomic<quint64>>(0) };
+    ValidationState m_validationState { ValidationState::None };
+    QStringListModel *m_completionModel { nullptr };
+    QPointer<QCompleter> m_completionPopup;
+    QString m_acceptedCompletion;
+    BeautyShadow *m_shadow;
+    BeautySnapshot *m_snapshot;
+    BeautyOpaqueBackground m_opaque;
     static constexpr int kMargin = 5;
     static constexpr qreal kRestScale = 0.98;
     static constexpr qreal kFocusScale = 1.0;
@@ -0,0 +1,51 @@
+#include "beautyopaquebackground.h"
+#include "beautyshadow.h"
+#include "beautyshadoweffect.h"
+#include "beautysnapshot.h"
+#include <QPainter>
+#include <QWidget>
+
+BeautyOpaqueBackground::BeautyOpaqueBackground(QWidget *widget, BeautyShadow *shadow,
+                                               BeautySnapshot *snapshot)
+    : m_widget(widget)
+    , m_shadow(shadow)
+    , m_snapshot(snapshot)
+{
+}
+
+void BeautyOpaqueBackground::setColor(const QColor &color)
+{
+    QColor background = color;
+    if (background.isValid()) {
+        background.setAlpha(255);
+    }
+    if (m_color == background) {
+        return;
+    }
+
+    const bool wasOpaque = isEnabled();
+    m_color = background;
+    const bool opaque = isEnabled();
+    m_widget->setAttribute(Qt::WA_TranslucentBackground, !opaque);
+    m_widget->setAttribute(Qt::WA_OpaquePaintEvent, opaque);
+    if (opaque != wasOpaque) {
+        if (opaque) {
+            m_widget->setGraphicsEffect(nullptr);
+            QObject::connect(m_shadow, &BeautyShadow::extentChanged, m_widget, qOverload<>(&QWidget::update));
+            QObject::connect(m_shadow, &BeautyShadow::changed, m_widget, qOverload<>(&QWidget::update));
+        } else {
+            QObject::disconnect(m_shadow, &BeautyShadow::extentChanged, m_widget, qOverload<>(&QWidget::update));
+            QObject::disconnect(m_shadow, &BeautyShadow::changed, m_widget, qOverload<>(&QWidget::update));
+            m_widget->setGraphicsEffect(new BeautyShadowEffect(m_shadow, m_widget));
+        }
+        m_snapshot->effectChanged();
+    }
+    m_widget->update();
+}
+
+void BeautyOpaqueBackground::paint(QPainter *p) const
+{
+    const QRect r = m_widget->rect();
+    p->fillRect(r, m_color);
+    m_shadow->draw(p, m_shadow->maxBlurWithin(r));
+}
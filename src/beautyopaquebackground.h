@@ -0,0 +1,36 @@
+#pragma once
+
+#include <QColor>
+
+class BeautyShadow;
+class BeautySnapshot;
+class QPainter;
+class QWidget;
+
+// Opt-in fast path for widgets on a known solid background. The widget fills its own
+// rect with the background colour, declares itself opaque and paints its shadow inside
+// its margin, so animating it never repaints the parent or siblings. An invalid colour
+// returns to the translucent default.
+//
+// Qt treats any widget with a graphics effect as translucent, enabled or not, so opaque
+// mode removes the widget's BeautyShadowEffect and the translucent default installs a
+// new one around the same BeautyShadow.
+class BeautyOpaqueBackground {
+public:
+    BeautyOpaqueBackground(QWidget *widget, BeautyShadow *shadow, BeautySnapshot *snapshot);
+
+    QColor color() const { return m_color; }
+    bool   isEnabled() const { return m_color.isValid(); }
+    void   setColor(const QColor &color);
+
+    // Fills the widget and draws the shadow, its blur capped so that the offset and the
+    // scale the widget applies never push it past the widget's edge. Call first in
+    // paintEvent, and only while enabled.
+    void paint(QPainter *p) const;
+
+private:
+    QWidget *m_widget;
+    BeautyShadow *m_shadow;
+    BeautySnapshot *m_snapshot;
+    QColor m_color;
+};
@@ -0,0 +1,44 @@
+#include "beautypainter.h"
+#include "beautyrendercache.h"
+#include <QPainter>
+
+namespace BeautyPainter {
+
+void applyFloatTransform(QPainter *p, const QRectF &rect, qreal scale, const QPointF &offset)
+{
+    p->translate(offset);
+    p->translate(rect.center());
+    p->scale(scale, scale);
+    p->translate(-rect.center());
+}
+
+QColor mixWithWhite(const QColor &c, qreal factor)
+{
+    return QColor::fromRgbF(
+        c.redF()   * (1.0 - factor) + 1.0 * factor,
+        c.greenF() * (1.0 - factor) + 1.0 * factor,
+        c.blueF()  * (1.0 - factor) + 1.0 * factor,
+        1.0
+        );
+}
+
+void drawBody(QPainter *p, const QRectF &rect, qreal radius, const QColor &color,
+              bool cacheable, qreal dpr)
+{
+    // A scaled raster would be resampled and lose the crisp edge, so only pure
+    // translations use the cache.
+    const BeautyRenderCache::Raster body = cacheable && p->transform().type() <= QTransform::TxTranslate
+        ? BeautyRenderCache::instance().body(rect.size(), radius, color, dpr)
+        : BeautyRenderCache::Raster();
+    if (!body.isNull()) {
+        BeautyRenderCache::draw(p, rect, body);
+        return;
+    }
+    p->save();
+    p->setBrush(color);
+    p->setPen(Qt::NoPen);
+    p->drawRoundedRect(rect, radius, radius);
+    p->restore();
+}
+
+} // namespace BeautyPainter
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <QColor>
+#include <QPointF>
+#include <QRectF>
+
+class QPainter;
+
+// Drawing path shared by all Beauty widgets.
+namespace BeautyPainter {
+
+// Scales rect around its centre and shifts it by offset, the "floating" transform the
+// widgets animate on hover and press.
+void applyFloatTransform(QPainter *p, const QRectF &rect, qreal scale, const QPointF &offset);
+
+// Opaque colour factor of the way from c to white; the pale tints derived from a theme colour.
+QColor mixWithWhite(const QColor &c, qreal factor);
+
+// Fills the rounded body. Resting colours at their natural size come from the shared
+// raster cache; transient animation colours and scaled bodies are painted directly.
+void drawBody(QPainter *p, const QRectF &rect, qreal radius, const QColor &color,
+              bool cacheable, qreal dpr);
+
+} // namespace BeautyPainter
@@ -0,0 +1,178 @@
+#include "beautyprogressbar.h"
+#include "beautypainter.h"
+#include <QPainter>
+#include <QTimer>
+
+#include <vector>
+#include <algorithm>
+
+// One GUI-thread timer polls every live bar, so the number of bars and of worker
+// updates never turns into timers or queued events.
+class BeautyProgressSampler : public QObject {
+public:
+    static BeautyProgressSampler &instance()
+    {
+        static BeautyProgressSampler sampler;
+        return sampler;
+    }
+
+    void add(BeautyProgressBar *bar)
+    {
+        m_bars.push_back(bar);
+        if (!m_timer.isActive()) {
+            m_timer.start();
+        }
+    }
+
+    void remove(BeautyProgressBar *bar)
+    {
+        m_bars.erase(std::remove(m_bars.begin(), m_bars.end(), bar), m_bars.end());
+        if (m_bars.empty()) {
+            m_timer.stop();
+        }
+    }
+
+    void setInterval(int ms) { m_timer.setInterval(qMax(1, ms)); }
+
+private:
+    BeautyProgressSampler()
+    {
+        m_timer.setTimerType(Qt::PreciseTimer);
+        m_timer.setInterval(16);
+        connect(&m_timer, &QTimer::timeout, this, [this] {
+            for (BeautyProgressBar *bar : m_bars) {
+                bar->sample();
+            }
+        });
+    }
+
+    std::vector<BeautyProgressBar*> m_bars;
+    QTimer m_timer;
+};
+
+BeautyProgressBar::BeautyProgressBar(QWidget *parent)
+    : QWidget(parent)
+{
+    setAttribute(Qt::WA_TranslucentBackground, true);
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+    setThemeColor(m_themeColor);
+    BeautyProgressSampler::instance().add(this);
+}
+
+BeautyProgressBar::~BeautyProgressBar()
+{
+    BeautyProgressSampler::instance().remove(this);
+}
+
+void BeautyProgressBar::setFrameInterval(int ms)
+{
+    BeautyProgressSampler::instance().setInterval(ms);
+}
+
+void BeautyProgressBar::setRange(int minimum, int maximum)
+{
+    m_minimum = minimum;
+    m_maximum = qMax(minimum, maximum);
+    update();
+}
+
+void BeautyProgressBar::setThemeColor(const QColor &c)
+{
+    m_themeColor = c;
+    m_trackColor = BeautyPainter::mixWithWhite(c, 0.9);
+    update();
+}
+
+void BeautyProgressBar::setDisabledTrackColor(const QColor &c)
+{
+    m_disabledTrackColor = c;
+    if (!isEnabled()) {
+        update();
+    }
+}
+
+void BeautyProgressBar::setDisabledColor(const QColor &c)
+{
+    m_disabledColor = c;
+    if (!isEnabled()) {
+        update();
+    }
+}
+
+void BeautyProgressBar::setTextColor(const QColor &c)
+{
+    m_textColor = c;
+    update();
+}
+
+void BeautyProgressBar::setTextVisible(bool visible)
+{
+    if (m_textVisible == visible) {
+        return;
+    }
+    m_textVisible = visible;
+    update();
+}
+
+QSize BeautyProgressBar::sizeHint() const
+{
+    return QSize(160, fontMetrics().height() + 6 + kMargin * 2);
+}
+
+QRectF BeautyProgressBar::innerRect() const
+{
+    return QRectF(rect()).adjusted(kMargin, kMargin, -kMargin, -kMargin);
+}
+
+qreal BeautyProgressBar::fraction(qreal v) const
+{
+    if (m_maximum <= m_minimum) {
+        return 0.0;
+    }
+    return qBound<qreal>(0.0, (v - m_minimum) / qreal(m_maximum - m_minimum), 1.0);
+}
+
+void BeautyProgressBar::sample()
+{
+    const int target = qBound(m_minimum, value(), m_maximum);
+    if (target == m_target && qFuzzyCompare(m_displayValue + 1.0, m_target + 1.0)) {
+        return;
+    }
+    m_target = target;
+    if (!isVisible()) {
+        m_displayValue = target;
+        return;
+    }
+
+    // Ease towards the target, snapping once the remaining step is below a pixel.
+    const qreal next = m_displayValue + (m_target - m_displayValue) * kEase;
+    const qreal pixel = (m_maximum - m_minimum) / qMax<qreal>(1.0, innerRect().width());
+    m_displayValue = qAbs(m_target - next) < pixel ? m_target : next;
+    update();
+}
+
+void BeautyProgressBar::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+    QPainter p(this);
+    p.setRenderHint(QPainter::Antialiasing, true);
+
+    const QRectF r = innerRect();
+    const qreal radius = r.height() / 2.0;
+    BeautyPainter::drawBody(&p, r, radius, isEnabled() ? m_trackColor : m_disabledTrackColor,
+                            true, devicePixelRatioF());
+
+    const qreal f = fraction(m_displayValue);
+    if (f > 0.0) {
+        // The fill width changes every frame while easing, so it is not cached.
+        const QRectF fill(r.topLeft(), QSizeF(qMax(r.height(), r.width() * f), r.height()));
+        BeautyPainter::drawBody(&p, fill, radius, isEnabled() ? m_themeColor : m_disabledColor,
+                                false, devicePixelRatioF());
+    }
+
+    if (m_textVisible) {
+        p.setPen(f > 0.5 ? m_textColor : m_themeColor);
+        p.setFont(font());
+        p.drawText(r, Qt::AlignCenter, QStringLiteral("%1%").arg(qRound(fraction(m_target) * 100)));
+    }
+}
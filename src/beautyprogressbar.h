@@ -0,0 +1,63 @@
+#pragma once
+#include <QWidget>
+#include <QColor>
+
+#include <atomic>
+
+// Pill-shaped progress bar that worker threads can feed directly. setValue() is a
+// relaxed atomic store and sends no signal or event; the GUI thread samples all bars
+// once per frame and only eases and repaints the ones whose value changed.
+class BeautyProgressBar : public QWidget {
+    Q_OBJECT
+    Q_PROPERTY(int  value READ value WRITE setValue)
+    Q_PROPERTY(bool textVisible READ isTextVisible WRITE setTextVisible)
+
+public:
+    explicit BeautyProgressBar(QWidget *parent = nullptr);
+    ~BeautyProgressBar() override;
+
+    // Safe to call from any thread.
+    void setValue(int value) { m_value.store(value, std::memory_order_relaxed); }
+    int  value() const { return m_value.load(std::memory_order_relaxed); }
+
+    void setRange(int minimum, int maximum);
+    int  minimum() const { return m_minimum; }
+    int  maximum() const { return m_maximum; }
+
+    void setThemeColor(const QColor &c);
+    // Track and fill colours while the bar is disabled.
+    void setDisabledTrackColor(const QColor &c);
+    void setDisabledColor(const QColor &c);
+    void setTextColor(const QColor &c);
+    bool isTextVisible() const { return m_textVisible; }
+    void setTextVisible(bool visible);
+
+    QSize sizeHint() const override;
+
+    // Sampling period shared by all bars, in milliseconds.
+    static void setFrameInterval(int ms);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    friend class BeautyProgressSampler;
+    void sample();
+    qreal fraction(qreal v) const;
+    QRectF innerRect() const;
+
+private:
+    std::atomic<int> m_value { 0 };
+    int    m_minimum { 0 };
+    int    m_maximum { 100 };
+    int    m_target { 0 };
+    qreal  m_displayValue { 0 };
+    QColor m_themeColor { QColor("#003494") };
+    QColor m_trackColor;
+    QColor m_disabledTrackColor { QColor("#eaeaea") };
+    QColor m_disabledColor { QColor("#808080") };
+    QColor m_textColor { Qt::white };
+    bool   m_textVisible { true };
+    static constexpr int kMargin = 2;
+    static constexpr qreal kEase = 0.3;
+};
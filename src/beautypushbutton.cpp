@@ -1,12 +1,21 @@
 #include "BeautyPushButton.h"
+#include "beautyanimationbudget.h"
+#include "beautyiconcache.h"
+#include "beautypainter.h"
+#include "beautyshadow.h"
+#include "beautyshadoweffect.h"
+#include "beautysnapshot.h"
+#include <QHashFunctions>
 #include <QPainter>
 #include <QPainterPath>
 #include <QPropertyAnimation>
 #include <QMouseEvent>
-#include <QGraphicsDropShadowEffect>
 
 BeautyPushButton::BeautyPushButton(QWidget *parent)
     : QPushButton(parent)
+    , m_shadow(new BeautyShadow(this))
+    , m_snapshot(new BeautySnapshot(this))
+    , m_opaque(this, m_shadow, m_snapshot)
 {
 #ifdef Q_OS_MAC
     setAttribute(Qt::WA_MacShowFocusRect, false);
@@ -16,11 +25,8 @@ BeautyPushButton::BeautyPushButton(QWidget *parent)
     setCursor(Qt::PointingHandCursor);
     setAttribute(Qt::WA_TranslucentBackground, true);
 
-    auto *shadow = new QGraphicsDropShadowEffect(this);
-    shadow->setBlurRadius(0);
-    shadow->setOffset(0, 0);
-    shadow->setColor(QColor(0, 0, 0, 100));
-    setGraphicsEffect(shadow);
+    m_shadow->setColor(QColor(0, 0, 0, 100));
+    setGraphicsEffect(new BeautyShadowEffect(m_shadow, this));
     setScale(1);
 
     connect(this, &QPushButton::toggled, this, [this](bool checked){
@@ -54,7 +60,7 @@ void BeautyPushButton::setThemeColor(const QColor &base)
         back->setStartValue(m_offset);
         back->setEndValue(QPointF(0, 0));
         back->setEasingCurve(QEasingCurve::OutCubic);
-        back->start(QAbstractAnimation::DeleteWhenStopped);
+        BeautyAnimationBudget::instance().start(back, this);
     }
     update();
 }
@@ -158,19 +164,15 @@ void BeautyPushButton::changeEvent(QEvent *event)
 {
     QPushButton::changeEvent(event);
     if (event->type() == QEvent::EnabledChange) {
+        m_snapshot->syncEnabled();
         if (!isEnabled()) {
-            const auto anims = findChildren<QAbstractAnimation*>();
-            for (auto *a : anims) {
-                if (a) a->stop();
-            }
+            BeautyAnimationBudget::instance().stopAll(this);
             setCursor(Qt::ArrowCursor);
             setOffset(QPointF(0, 0));
             setScale(1.0);
             setBgColor(m_disabledColor);
-            if (auto *shadow = qobject_cast<QGraphicsDropShadowEffect*>(graphicsEffect())) {
-                shadow->setBlurRadius(0);
-                shadow->setOffset(0, 0);
-            }
+            m_shadow->setBlurRadius(0);
+            m_shadow->setOffset(0, 0);
             return;
         }
         setCursor(Qt::PointingHandCursor);
@@ -192,6 +194,12 @@ QRectF BeautyPushButton::innerRect() const {
     return QRectF(rect()).adjusted(kMargin, kMargin, -kMargin, -kMargin);
 }
 
+void BeautyPushButton::resizeEvent(QResizeEvent *event)
+{
+    QPushButton::resizeEvent(event);
+    syncShadowShape();
+}
+
 void BeautyPushButton::setBgColor(const QColor &c){
     m_bgColor = c;
     update();
@@ -199,25 +207,34 @@ void BeautyPushButton::setBgColor(const QColor &c){
 
 void BeautyPushButton::setScale(qreal s){
     m_scale = s;
+    syncShadowShape();
+    update();
+}
+
+void BeautyPushButton::setOffset(const QPointF &o)
+{
+    m_offset = o;
+    syncShadowShape();
     update();
 }
 
 void BeautyPushButton::paintEvent(QPaintEvent *event)
 {
     Q_UNUSED(event);
+    if (m_snapshot->paint([this] { return snapshotKey(); })) {
+        return;
+    }
+
     QPainter p(this);
     p.setRenderHint(QPainter::Antialiasing, true);
-
-    p.translate(m_offset);
+    if (m_opaque.isEnabled()) {
+        m_opaque.paint(&p);
+    }
 
     const QRectF r = innerRect();
-    p.translate(r.center());
-    p.scale(m_scale, m_scale);
-    p.translate(-r.center());
-
-    p.setBrush(m_bgColor);
-    p.setPen(Qt::NoPen);
-    p.drawRoundedRect(r, 8, 8);
+    BeautyPainter::applyFloatTransform(&p, r, m_scale, m_offset);
+    BeautyPainter::drawBody(&p, r, kCornerRadius, m_bgColor, isRestingColor(m_bgColor),
+                            devicePixelRatioF());
 
     if (m_borderEnabled && m_borderWidth > 0.0) {
         QColor borderColor = m_borderColor;
@@ -230,7 +247,7 @@ void BeautyPushButton::paintEvent(QPaintEvent *event)
         p.setPen(borderPen);
         const qreal halfBorderWidth = m_borderWidth / 2.0;
         p.drawRoundedRect(r.adjusted(halfBorderWidth, halfBorderWidth,
-                                     -halfBorderWidth, -halfBorderWidth), 8, 8);
+                                     -halfBorderWidth, -halfBorderWidth), kCornerRadius, kCornerRadius);
     }
 
     QColor textColor = m_textColor;
@@ -239,7 +256,78 @@ void BeautyPushButton::paintEvent(QPaintEvent *event)
     }
     p.setPen(textColor);
     p.setFont(font());
-    p.drawText(r, m_textAlignment, text());
+
+    const QPixmap iconPixmap = BeautyIconCache::instance().tinted(icon(), iconSize(),
+                                                                  iconColor(), devicePixelRatioF());
+    if (iconPixmap.isNull()) {
+        p.drawText(r, m_textAlignment, text());
+        return;
+    }
+
+    // Icon and text are laid out as one block, aligned like the text alone would be.
+    const QRectF content = r.adjusted(kIconPadding, 0, -kIconPadding, 0);
+    const QSizeF iconSz = iconPixmap.deviceIndependentSize();
+    const qreal textWidth = text().isEmpty() ? 0.0 : fontMetrics().horizontalAdvance(text());
+    const qreal blockWidth = qMin(content.width(), iconSz.width() + (textWidth > 0 ? kIconSpacing + textWidth : 0.0));
+    qreal x = content.left() + (content.width() - blockWidth) / 2.0;
+    if (m_textAlignment & Qt::AlignLeft) {
+        x = content.left();
+    } else if (m_textAlignment & Qt::AlignRight) {
+        x = content.right() - blockWidth;
+    }
+
+    p.setRenderHint(QPainter::SmoothPixmapTransform, p.transform().type() > QTransform::TxTranslate);
+    p.drawPixmap(QPointF(x, r.center().y() - iconSz.height() / 2.0), iconPixmap);
+    if (textWidth > 0) {
+        const QRectF textRect(x + iconSz.width() + kIconSpacing, r.top(),
+                              blockWidth - iconSz.width() - kIconSpacing, r.height());
+        p.drawText(textRect, Qt::AlignLeft | (m_textAlignment & Qt::AlignVertical_Mask),
+                   fontMetrics().elidedText(text(), Qt::ElideRight, int(textRect.width())));
+    }
+}
+
+void BeautyPushButton::setOpaqueBackground(const QColor &color)
+{
+    m_opaque.setColor(color);
+}
+
+void BeautyPushButton::setIconColor(IconState state, const QColor &c)
+{
+    m_iconColors[int(state)] = c;
+    update();
+}
+
+QColor BeautyPushButton::iconColor() const
+{
+    IconState state = IconState::Normal;
+    if (!isEnabled()) {
+        state = IconState::Disabled;
+    } else if (isDown()) {
+        state = IconState::Pressed;
+    } else if (isCheckable() && isChecked()) {
+        state = IconState::Checked;
+    }
+
+    const QColor &explicitColor = m_iconColors[int(state)];
+    if (explicitColor.isValid()) {
+        return explicitColor;
+    }
+    QColor c = m_textColor;
+    if (state == IconState::Disabled) {
+        c.setAlphaF(qBound(0.0, c.alphaF() * 0.6, 1.0));
+    }
+    return c;
+}
+
+// Everything paintEvent depends on besides size and device pixel ratio.
+size_t BeautyPushButton::snapshotKey() const
+{
+    return qHashMulti(0, text(), icon().cacheKey(), iconSize().width(), iconSize().height(),
+                      isEnabled(), m_bgColor.rgba(), m_textColor.rgba(), iconColor().rgba(),
+                      m_borderEnabled, m_borderColor.rgba(), m_borderWidth, int(m_textAlignment),
+                      m_scale, m_offset.x(), m_offset.y(), m_opaque.color().rgba(),
+                      m_shadow->blurRadius(), m_shadow->offset().x(), m_shadow->offset().y(),
+                      palette().cacheKey(), font().key());
 }
 
 void BeautyPushButton::mouseMoveEvent(QMouseEvent *event)
@@ -271,6 +359,7 @@ void BeautyPushButton::enterEvent(QEnterEvent *event)
         event->ignore();
         return;
     }
+    m_snapshot->wake();
     animateScale(shouldKeepFloating() ? 1.0 : 1.01);
     syncShadowState();
     QPushButton::enterEvent(event);
@@ -288,7 +377,7 @@ void BeautyPushButton::leaveEvent(QEvent *event)
     back->setStartValue(m_offset);
     back->setEndValue(QPointF(0,0));
     back->setEasingCurve(QEasingCurve::OutCubic);
-    back->start(QAbstractAnimation::DeleteWhenStopped);
+    BeautyAnimationBudget::instance().start(back, this);
 
     syncShadowState();
 
@@ -301,6 +390,7 @@ void BeautyPushButton::mousePressEvent(QMouseEvent *event)
         event->ignore();
         return;
     }
+    m_snapshot->wake();
     animateColor(QColor(m_pressedColor));
     animateScale(0.95);
 
@@ -326,7 +416,7 @@ void BeautyPushButton::mouseReleaseEvent(QMouseEvent *event)
 bool BeautyPushButton::hitButton(const QPoint &pos) const
 {
     QPainterPath path;
-    path.addRoundedRect(innerRect(), 8, 8);
+    path.addRoundedRect(innerRect(), kCornerRadius, kCornerRadius);
     return path.contains(pos);
 }
 
@@ -337,7 +427,7 @@ void BeautyPushButton::animateColor(const QColor &to)
     anim->setStartValue(m_bgColor);
     anim->setEndValue(to);
     anim->setEasingCurve(QEasingCurve::OutCubic);
-    anim->start(QAbstractAnimation::DeleteWhenStopped);
+    BeautyAnimationBudget::instance().start(anim, this);
 }
 
 void BeautyPushButton::animateScale(qreal to)
@@ -347,29 +437,24 @@ void BeautyPushButton::animateScale(qreal to)
     anim->setStartValue(m_scale);
     anim->setEndValue(to);
     anim->setEasingCurve(QEasingCurve::OutCubic);
-    anim->start(QAbstractAnimation::DeleteWhenStopped);
+    BeautyAnimationBudget::instance().start(anim, this);
 }
 
 void BeautyPushButton::animateShadow(qreal blurRadius, const QPointF &offset)
 {
-    auto *shadow = qobject_cast<QGraphicsDropShadowEffect*>(graphicsEffect());
-    if (!shadow) {
-        return;
-    }
-
-    auto *blur = new QPropertyAnimation(shadow, "blurRadius");
+    auto *blur = new QPropertyAnimation(m_shadow, "blurRadius");
     blur->setDuration(150);
-    blur->setStartValue(shadow->blurRadius());
+    blur->setStartValue(m_shadow->blurRadius());
     blur->setEndValue(blurRadius);
     blur->setEasingCurve(QEasingCurve::OutCubic);
-    blur->start(QAbstractAnimation::DeleteWhenStopped);
+    BeautyAnimationBudget::instance().start(blur, this);
 
-    auto *offsetAnim = new QPropertyAnimation(shadow, "offset");
+    auto *offsetAnim = new QPropertyAnimation(m_shadow, "offset");
     offsetAnim->setDuration(150);
-    offsetAnim->setStartValue(shadow->offset());
+    offsetAnim->setStartValue(m_shadow->offset());
     offsetAnim->setEndValue(offset);
     offsetAnim->setEasingCurve(QEasingCurve::OutCubic);
-    offsetAnim->start(QAbstractAnimation::DeleteWhenStopped);
+    BeautyAnimationBudget::instance().start(offsetAnim, this);
 }
 
 void BeautyPushButton::syncShadowState()
@@ -382,3 +467,14 @@ bool BeautyPushButton::shouldKeepFloating() const
 {
     return m_floatingOnChecked && isCheckable() && isChecked();
 }
+
+void BeautyPushButton::syncShadowShape()
+{
+    m_shadow->setShape(innerRect(), kCornerRadius);
+    m_shadow->setShapeTransform(m_scale, m_offset);
+}
+
+bool BeautyPushButton::isRestingColor(const QColor &c) const
+{
+    return c == m_normalColor || c == m_pressedColor || c == m_checkedColor || c == m_disabledColor;
+}
@@ -4,6 +4,11 @@
 #include <QPointF>
 #include <Qt>
 
+#include "beautyopaquebackground.h"
+
+class BeautyShadow;
+class BeautySnapshot;
+
 class BeautyPushButton : public QPushButton {
     Q_OBJECT
     Q_PROPERTY(QColor  bgColor READ bgColor  WRITE setBgColor)
@@ -16,6 +21,14 @@ class BeautyPushButton : public QPushButton {
     Q_PROPERTY(Qt::Alignment textAlignment READ textAlignment WRITE setTextAlignment)
 
 public:
+    enum class IconState {
+        Normal,
+        Pressed,
+        Checked,
+        Disabled
+    };
+    Q_ENUM(IconState)
+
     explicit BeautyPushButton(QWidget *parent = nullptr);
 
     void setThemeColor(const QColor &base);
@@ -36,16 +49,22 @@ public:
     void    setTextAlignment(Qt::Alignment alignment);
     QColor  bgColor() const { return m_bgColor; }
     void    setBgColor(const QColor &c);
+    // Icon tint per state; an invalid colour follows the text colour.
+    void    setIconColor(IconState state, const QColor &c);
+    // See BeautyOpaqueBackground.
+    void    setOpaqueBackground(const QColor &color);
+    QColor  opaqueBackground() const { return m_opaque.color(); }
 
 private:
     qreal   scale()  const { return m_scale; }
     void    setScale(qreal s);
     QPointF offset() const { return m_offset; }
-    void    setOffset(const QPointF &o) { m_offset = o; update(); }
+    void    setOffset(const QPointF &o);
 
 protected:
     void changeEvent(QEvent *event) override;
     QSize sizeHint() const override;
+    void resizeEvent(QResizeEvent *event) override;
     void paintEvent(QPaintEvent *event) override;
     void mouseMoveEvent(QMouseEvent *event) override;
     void enterEvent(QEnterEvent *event) override;
@@ -60,6 +79,10 @@ private:
     void animateShadow(qreal blurRadius, const QPointF &offset);
     void syncShadowState();
     bool shouldKeepFloating() const;
+    void syncShadowShape();
+    bool isRestingColor(const QColor &c) const;
+    QColor iconColor() const;
+    size_t snapshotKey() const;
 
     QRectF innerRect() const;
 
@@ -83,5 +106,12 @@ private:
     QColor m_borderColor { Qt::black };
     qreal m_borderWidth { 1.0 };
     Qt::Alignment m_textAlignment { Qt::AlignCenter };
+    QColor m_iconColors[4];
+    BeautyShadow *m_shadow;
+    BeautySnapshot *m_snapshot;
+    BeautyOpaqueBackground m_opaque;
     static constexpr int kMargin = 6;
+    static constexpr qreal kCornerRadius = 8;
+    static constexpr qreal kIconPadding = 8;
+    static constexpr qreal kIconSpacing = 6;
 };
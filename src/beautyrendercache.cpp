@@ -0,0 +1,725 @@
+#include "beautyrendercache.h"
+#include "beautyblur.h"
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QFile>
+#include <QPainter>
+#include <QSaveFile>
+#include <QSysInfo>
+#include <QtMath>
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+#ifndef BEAUTY_WIDGETS_VERSION
+#define BEAUTY_WIDGETS_VERSION "0.0"
+#endif
+
+namespace {
+
+constexpr quint32 kFileMagic = 0x43525742; // "BWRC"
+constexpr quint32 kFileFormat = 3;
+constexpr qint64 kDefaultMaxBytes = 32 * 1024 * 1024;
+constexpr int kMaxImageSide = 4096;
+constexpr int kPageSide = 1024;
+constexpr int kGutter = 1;
+constexpr quint64 kBlobAlignment = 16;
+
+struct FileHeader {
+    quint32 magic;
+    quint32 format;
+    quint64 libraryHash;
+    quint32 pageCount;
+    quint32 entryCount;
+};
+
+struct FilePage {
+    quint32 width;
+    quint32 height;
+    quint32 bytesPerLine;
+    quint32 reserved;
+    quint64 offset;
+};
+
+struct FileEntry {
+    quint8  kind;
+    quint8  reserved[3];
+    quint16 width;
+    quint16 height;
+    quint16 radius;
+    quint16 blur;
+    quint16 dpr;
+    quint16 reserved2;
+    quint32 color;
+    quint32 page;
+    quint32 x;
+    quint32 y;
+    quint32 imageWidth;
+    quint32 imageHeight;
+};
+
+static_assert(std::is_trivially_copyable_v<FileHeader>);
+static_assert(std::is_trivially_copyable_v<FilePage>);
+static_assert(std::is_trivially_copyable_v<FileEntry>);
+
+quint16 clampToU16(qreal v)
+{
+    return quint16(qBound<qreal>(0.0, qRound(v), 65535.0));
+}
+
+quint64 alignUp(quint64 v)
+{
+    return (v + kBlobAlignment - 1) & ~(kBlobAlignment - 1);
+}
+
+QSize imageSizeFor(const BeautyRenderCache::Key &key)
+{
+    const qreal dpr = key.dpr / 100.0;
+    const int pad = key.kind == BeautyRenderCache::Kind::Shadow ? key.blur : 0;
+    return QSize(qCeil((key.width + 2 * pad) * dpr), qCeil((key.height + 2 * pad) * dpr));
+}
+
+void copyPixels(const QImage &src, const QRect &from, QImage &dst, const QPoint &to)
+{
+    const size_t rowBytes = size_t(from.width()) * 4;
+    for (int y = 0; y < from.height(); ++y) {
+        std::memcpy(dst.scanLine(to.y() + y) + to.x() * 4,
+                    src.constScanLine(from.y() + y) + from.x() * 4, rowBytes);
+    }
+}
+
+} // namespace
+
+BeautyRenderCache &BeautyRenderCache::instance()
+{
+    static BeautyRenderCache cache;
+    return cache;
+}
+
+BeautyRenderCache::BeautyRenderCache()
+    : m_maxBytes(kDefaultMaxBytes)
+{
+}
+
+BeautyRenderCache::~BeautyRenderCache()
+{
+    // Pages loaded from disk point into the mappings, drop them first.
+    m_pages.clear();
+}
+
+quint64 BeautyRenderCache::libraryHash()
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArrayLiteral(BEAUTY_WIDGETS_VERSION));
+    hash.addData(QByteArray::number(kFileFormat));
+    hash.addData(QByteArray(qVersion()));
+    hash.addData(QSysInfo::buildAbi().toLatin1());
+    const QByteArray digest = hash.result();
+    quint64 h = 0;
+    std::memcpy(&h, digest.constData(), sizeof(h));
+    return h;
+}
+
+BeautyRenderCache::Key BeautyRenderCache::makeKey(Kind kind, const QSizeF &size, qreal radius,
+                                                  const QColor &color, qreal blur, qreal dpr)
+{
+    Key key;
+    key.kind   = kind;
+    key.width  = clampToU16(size.width());
+    key.height = clampToU16(size.height());
+    key.radius = clampToU16(radius * 4.0);
+    key.blur   = kind == Kind::Shadow ? clampToU16(blur) : 0;
+    key.dpr    = clampToU16(dpr * 100.0);
+    key.color  = color.rgba();
+    return key;
+}
+
+BeautyRenderCache::Raster BeautyRenderCache::shadow(const QSizeF &size, qreal radius,
+                                                    const QColor &color, qreal blur, qreal dpr)
+{
+    const Key key = makeKey(Kind::Shadow, size, radius, color, blur, dpr);
+    const Raster cached = lookup(key);
+    if (!cached.isNull()) {
+        return cached;
+    }
+    return insert(key, render(key));
+}
+
+BeautyRenderCache::Raster BeautyRenderCache::body(const QSizeF &size, qreal radius,
+                                                  const QColor &color, qreal dpr)
+{
+    const Key key = makeKey(Kind::Body, size, radius, color, 0, dpr);
+    const Raster cached = lookup(key);
+    if (!cached.isNull()) {
+        return cached;
+    }
+    return insert(key, render(key));
+}
+
+void BeautyRenderCache::draw(QPainter *painter, const QRectF &target, const Raster &raster)
+{
+    if (!raster.isNull()) {
+        painter->drawImage(target, raster.page, raster.source);
+    }
+}
+
+BeautyRenderCache::Raster BeautyRenderCache::lookup(const Key &key)
+{
+    const auto it = m_entries.find(key);
+    if (it == m_entries.end()) {
+        ++m_misses;
+        return Raster();
+    }
+    ++m_hits;
+    it->lastUse = ++m_clock;
+    Page &page = m_pages[size_t(it->page)];
+    page.lastUse = m_clock;
+    return Raster { page.image, it->rect };
+}
+
+QImage BeautyRenderCache::render(const Key &key) const
+{
+    const QSize imageSize = imageSizeFor(key);
+    if (imageSize.isEmpty() || imageSize.width() > kMaxImageSide || imageSize.height() > kMaxImageSide) {
+        return QImage();
+    }
+
+    const qreal dpr = key.dpr / 100.0;
+    const qreal pad = key.kind == Kind::Shadow ? key.blur : 0;
+    const qreal radius = key.radius / 4.0;
+    const QRectF shape(pad, pad, key.width, key.height);
+
+    if (key.kind == Kind::Body) {
+        QImage image(imageSize, QImage::Format_ARGB32_Premultiplied);
+        image.fill(Qt::transparent);
+        QPainter p(&image);
+        p.setRenderHint(QPainter::Antialiasing, true);
+        p.scale(dpr, dpr);
+        p.setPen(Qt::NoPen);
+        p.setBrush(QColor::fromRgba(key.color));
+        p.drawRoundedRect(shape, radius, radius);
+        return image;
+    }
+
+    // Shadows are blurred as a bare alpha mask and tinted afterwards.
+    QImage mask(imageSize, QImage::Format_Alpha8);
+    mask.fill(0);
+    {
+        QPainter p(&mask);
+        p.setRenderHint(QPainter::Antialiasing, true);
+        p.scale(dpr, dpr);
+        p.setPen(Qt::NoPen);
+        p.setBrush(Qt::black);
+        p.drawRoundedRect(shape, radius, radius);
+    }
+    BeautyBlur::blurAlpha(mask.bits(), mask.width(), mask.height(), int(mask.bytesPerLine()),
+                          BeautyBlur::sigmaForRadius(key.blur * dpr));
+
+    const QRgb color = qPremultiply(key.color);
+    const uint c[4] = { uint(qAlpha(color)), uint(qRed(color)), uint(qGreen(color)), uint(qBlue(color)) };
+    QImage image(imageSize, QImage::Format_ARGB32_Premultiplied);
+    for (int y = 0; y < image.height(); ++y) {
+        const uchar *in = mask.constScanLine(y);
+        auto *out = reinterpret_cast<QRgb *>(image.scanLine(y));
+        for (int x = 0; x < image.width(); ++x) {
+            const uint a = in[x];
+            out[x] = qRgba(int((c[1] * a + 127) / 255), int((c[2] * a + 127) / 255),
+                           int((c[3] * a + 127) / 255), int((c[0] * a + 127) / 255));
+        }
+    }
+    return image;
+}
+
+BeautyRenderCache::Raster BeautyRenderCache::insert(const Key &key, const QImage &image)
+{
+    if (image.isNull()) {
+        return Raster();
+    }
+
+    int pageIndex = -1;
+    QRect rect;
+    if (!allocate(image.size(), &pageIndex, &rect)) {
+        return Raster();
+    }
+
+    Page &page = m_pages[size_t(pageIndex)];
+    copyPixels(image, image.rect(), page.image, rect.topLeft());
+    page.occupied += qint64(rect.width()) * rect.height() * 4;
+    page.lastUse = ++m_clock;
+    m_entries.insert(key, Entry { pageIndex, rect, m_clock });
+    m_dirty = true;
+    return Raster { page.image, rect };
+}
+
+bool BeautyRenderCache::allocateInPage(Page &page, const QSize &size, QRect *rect)
+{
+    if (page.sealed) {
+        return false;
+    }
+
+    const int w = size.width() + kGutter;
+    const int h = size.height() + kGutter;
+    const int pageWidth = page.image.width();
+    const int pageHeight = page.image.height();
+
+    // Best fit among the open shelves; a much taller shelf only if nothing else fits.
+    Shelf *best = nullptr;
+    for (Shelf &shelf : page.shelves) {
+        if (shelf.height >= h && shelf.x + w <= pageWidth
+            && (!best || shelf.height < best->height)) {
+            best = &shelf;
+        }
+    }
+    const bool roomForShelf = page.bottom + h <= pageHeight && w <= pageWidth;
+    if (best && (best->height <= h * 2 || !roomForShelf)) {
+        *rect = QRect(QPoint(best->x, best->y), size);
+        best->x += w;
+        return true;
+    }
+    if (!roomForShelf) {
+        return false;
+    }
+
+    page.shelves.push_back(Shelf { page.bottom, h, w });
+    *rect = QRect(QPoint(0, page.bottom), size);
+    page.bottom += h;
+    return true;
+}
+
+bool BeautyRenderCache::allocate(const QSize &size, int *pageIndex, QRect *rect)
+{
+    const bool oversized = size.width() + kGutter > kPageSide || size.height() + kGutter > kPageSide;
+    const qint64 pageBytes = oversized ? qint64(size.width()) * size.height() * 4
+                                       : qint64(kPageSide) * kPageSide * 4;
+    if (pageBytes > m_maxBytes) {
+        return false;
+    }
+
+    bool defragmented = false;
+    for (;;) {
+        if (!oversized) {
+            for (size_t i = 0; i < m_pages.size(); ++i) {
+                if (allocateInPage(m_pages[i], size, rect)) {
+                    *pageIndex = int(i);
+                    return true;
+                }
+            }
+        }
+
+        if (bytesUsed() + pageBytes <= m_maxBytes) {
+            break;
+        }
+
+        // Out of budget: compact a fragmented atlas once, otherwise throw away the
+        // least recently used page.
+        const Stats s = stats();
+        if (!defragmented && s.occupancy < 0.5) {
+            defragment();
+            defragmented = true;
+            continue;
+        }
+        int victim = -1;
+        for (size_t i = 0; i < m_pages.size(); ++i) {
+            if (victim < 0 || m_pages[i].lastUse < m_pages[size_t(victim)].lastUse) {
+                victim = int(i);
+            }
+        }
+        if (victim < 0) {
+            return false;
+        }
+        evictPage(victim);
+        if (oversized) {
+            // A cleared shared page cannot hold it, release the memory instead.
+            m_pages[size_t(victim)].sealed = true;
+        }
+        dropEmptyPages();
+    }
+
+    Page page;
+    if (oversized) {
+        page.image = QImage(size, QImage::Format_ARGB32_Premultiplied);
+        page.sealed = true;
+        *rect = QRect(QPoint(0, 0), size);
+    } else {
+        page.image = QImage(kPageSide, kPageSide, QImage::Format_ARGB32_Premultiplied);
+        page.image.fill(Qt::transparent);
+        allocateInPage(page, size, rect);
+    }
+    if (page.image.isNull()) {
+        return false;
+    }
+    m_pages.push_back(std::move(page));
+    *pageIndex = int(m_pages.size() - 1);
+    return true;
+}
+
+void BeautyRenderCache::evictPage(int index)
+{
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (it->page == index) {
+            it = m_entries.erase(it);
+            ++m_evictions;
+        } else {
+            ++it;
+        }
+    }
+
+    Page &page = m_pages[size_t(index)];
+    page.occupied = 0;
+    if (!page.sealed) {
+        // Reused in place; clear it so old pixels never bleed through the gutters.
+        page.shelves.clear();
+        page.bottom = 0;
+        page.image.fill(Qt::transparent);
+    }
+    m_dirty = true;
+}
+
+void BeautyRenderCache::dropEmptyPages()
+{
+    std::vector<int> remap(m_pages.size(), -1);
+    std::vector<Page> kept;
+    for (size_t i = 0; i < m_pages.size(); ++i) {
+        if (m_pages[i].sealed && m_pages[i].occupied == 0) {
+            continue;
+        }
+        remap[i] = int(kept.size());
+        kept.push_back(std::move(m_pages[i]));
+    }
+    if (kept.size() == m_pages.size()) {
+        m_pages.swap(kept);
+        return;
+    }
+    m_pages.swap(kept);
+    for (Entry &entry : m_entries) {
+        entry.page = remap[size_t(entry.page)];
+    }
+}
+
+void BeautyRenderCache::defragment()
+{
+    std::vector<Page> old;
+    old.swap(m_pages);
+
+    // Tallest first packs shelves tightest.
+    std::vector<Key> keys;
+    keys.reserve(size_t(m_entries.size()));
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+        keys.push_back(it.key());
+    }
+    std::sort(keys.begin(), keys.end(), [this](const Key &a, const Key &b) {
+        return m_entries.value(a).rect.height() > m_entries.value(b).rect.height();
+    });
+
+    for (const Key &key : keys) {
+        Entry &entry = m_entries[key];
+        const Page &src = old[size_t(entry.page)];
+        const bool oversized = entry.rect.width() + kGutter > kPageSide
+                            || entry.rect.height() + kGutter > kPageSide;
+        QRect rect;
+        int target = -1;
+        if (oversized) {
+            Page page;
+            page.image = src.image.copy(entry.rect);
+            page.sealed = true;
+            rect = page.image.rect();
+            m_pages.push_back(std::move(page));
+            target = int(m_pages.size() - 1);
+        } else {
+            for (size_t i = 0; i < m_pages.size() && target < 0; ++i) {
+                if (allocateInPage(m_pages[i], entry.rect.size(), &rect)) {
+                    target = int(i);
+                }
+            }
+            if (target < 0) {
+                Page page;
+                page.image = QImage(kPageSide, kPageSide, QImage::Format_ARGB32_Premultiplied);
+                page.image.fill(Qt::transparent);
+                allocateInPage(page, entry.rect.size(), &rect);
+                m_pages.push_back(std::move(page));
+                target = int(m_pages.size() - 1);
+            }
+            copyPixels(src.image, entry.rect, m_pages[size_t(target)].image, rect.topLeft());
+        }
+
+        Page &dst = m_pages[size_t(target)];
+        dst.occupied += qint64(rect.width()) * rect.height() * 4;
+        dst.lastUse = qMax(dst.lastUse, entry.lastUse);
+        entry.page = target;
+        entry.rect = rect;
+    }
+    releaseMappings(); // every page is a fresh copy now
+    m_dirty = true;
+}
+
+void BeautyRenderCache::clear()
+{
+    m_entries.clear();
+    m_pages.clear();
+    releaseMappings();
+    m_dirty = true;
+}
+
+// Pages loaded from disk wrap the mapped bytes; copy them out before unmapping. Windows
+// cannot replace a file that is still mapped, so save() lets go of the file this way.
+void BeautyRenderCache::releaseMappings()
+{
+    for (Mapping &mapping : m_mappings) {
+        const quintptr begin = quintptr(mapping.base);
+        const quintptr end = begin + quintptr(mapping.size);
+        for (Page &page : m_pages) {
+            const quintptr bits = quintptr(page.image.constBits());
+            if (bits >= begin && bits < end) {
+                page.image = page.image.copy();
+            }
+        }
+        mapping.file->unmap(mapping.base);
+    }
+    m_mappings.clear();
+}
+
+void BeautyRenderCache::setMaxBytes(qint64 bytes)
+{
+    m_maxBytes = qMax<qint64>(0, bytes);
+    while (!m_pages.empty() && bytesUsed() > m_maxBytes) {
+        int victim = 0;
+        for (size_t i = 1; i < m_pages.size(); ++i) {
+            if (m_pages[i].lastUse < m_pages[size_t(victim)].lastUse) {
+                victim = int(i);
+            }
+        }
+        evictPage(victim);
+        m_pages[size_t(victim)].sealed = true; // let dropEmptyPages release it
+        dropEmptyPages();
+    }
+}
+
+qint64 BeautyRenderCache::bytesUsed() const
+{
+    qint64 bytes = 0;
+    for (const Page &page : m_pages) {
+        bytes += page.image.sizeInBytes();
+    }
+    return bytes;
+}
+
+BeautyRenderCache::Stats BeautyRenderCache::stats() const
+{
+    Stats s;
+    s.pages = int(m_pages.size());
+    s.entries = int(m_entries.size());
+    for (const Page &page : m_pages) {
+        s.bytesUsed += page.image.sizeInBytes();
+        s.bytesOccupied += page.occupied;
+    }
+    s.occupancy = s.bytesUsed > 0 ? qreal(s.bytesOccupied) / qreal(s.bytesUsed) : 0.0;
+    s.hits = m_hits;
+    s.misses = m_misses;
+    s.evictions = m_evictions;
+    return s;
+}
+
+bool BeautyRenderCache::setPersistentFile(const QString &path)
+{
+    m_path = path;
+    if (path.isEmpty()) {
+        return false;
+    }
+
+    if (!m_saveOnQuit) {
+        if (auto *app = QCoreApplication::instance()) {
+            QObject::connect(app, &QCoreApplication::aboutToQuit, app, [] {
+                BeautyRenderCache::instance().save();
+            });
+            m_saveOnQuit = true;
+        }
+    }
+    return load(path);
+}
+
+bool BeautyRenderCache::load(const QString &path)
+{
+    auto file = std::make_unique<QFile>(path);
+    if (!file->open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const qint64 fileSize = file->size();
+    if (fileSize < qint64(sizeof(FileHeader))) {
+        return false;
+    }
+
+    uchar *base = file->map(0, fileSize);
+    if (!base) {
+        return false;
+    }
+
+    FileHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    if (header.magic != kFileMagic || header.format != kFileFormat
+        || header.libraryHash != libraryHash()) {
+        return false;
+    }
+
+    const quint64 pagesStart = sizeof(FileHeader);
+    const quint64 entriesStart = pagesStart + quint64(header.pageCount) * sizeof(FilePage);
+    const quint64 tableEnd = entriesStart + quint64(header.entryCount) * sizeof(FileEntry);
+    if (tableEnd > quint64(fileSize)) {
+        return false;
+    }
+
+    // Pages wrap the mapped bytes and are sealed, so nothing ever writes to (and
+    // thereby deep-copies) them.
+    std::vector<Page> pages(header.pageCount);
+    for (quint32 i = 0; i < header.pageCount; ++i) {
+        FilePage record;
+        std::memcpy(&record, base + pagesStart + i * sizeof(FilePage), sizeof(record));
+        const quint64 byteCount = quint64(record.bytesPerLine) * record.height;
+        if (record.width == 0 || record.height == 0
+            || record.width > quint32(kMaxImageSide) || record.height > quint32(kMaxImageSide)
+            || record.bytesPerLine < record.width * 4 || record.bytesPerLine % 4 != 0
+            || record.offset % kBlobAlignment != 0 || record.offset < tableEnd
+            || record.offset + byteCount > quint64(fileSize)) {
+            return false;
+        }
+        pages[i].image = QImage(base + record.offset, int(record.width), int(record.height),
+                                int(record.bytesPerLine), QImage::Format_ARGB32_Premultiplied);
+        pages[i].sealed = true;
+    }
+
+    const int firstPage = int(m_pages.size());
+    std::vector<std::pair<Key, Entry>> loaded;
+    for (quint32 i = 0; i < header.entryCount; ++i) {
+        FileEntry record;
+        std::memcpy(&record, base + entriesStart + i * sizeof(FileEntry), sizeof(record));
+
+        Key key;
+        key.kind   = Kind(record.kind);
+        key.width  = record.width;
+        key.height = record.height;
+        key.radius = record.radius;
+        key.blur   = record.blur;
+        key.dpr    = record.dpr;
+        key.color  = record.color;
+        if ((key.kind != Kind::Shadow && key.kind != Kind::Body)
+            || record.page >= header.pageCount || m_entries.contains(key)) {
+            continue;
+        }
+
+        const QRect rect(int(record.x), int(record.y), int(record.imageWidth), int(record.imageHeight));
+        Page &page = pages[record.page];
+        if (imageSizeFor(key) != rect.size() || record.x > quint32(kMaxImageSide)
+            || record.y > quint32(kMaxImageSide) || !page.image.rect().contains(rect)) {
+            continue;
+        }
+        page.occupied += qint64(rect.width()) * rect.height() * 4;
+        loaded.push_back({ key, Entry { firstPage + int(record.page), rect, 0 } });
+    }
+
+    if (loaded.empty()) {
+        return false;
+    }
+    for (Page &page : pages) {
+        m_pages.push_back(std::move(page));
+    }
+    for (const auto &item : loaded) {
+        m_entries.insert(item.first, item.second);
+    }
+    dropEmptyPages();
+    m_mappings.push_back(Mapping { std::move(file), base, fileSize });
+    m_dirty = false;
+    return true;
+}
+
+bool BeautyRenderCache::save()
+{
+    if (m_path.isEmpty() || !m_dirty) {
+        return false;
+    }
+
+    std::vector<int> remap(m_pages.size(), -1);
+    std::vector<FilePage> pages;
+    for (size_t i = 0; i < m_pages.size(); ++i) {
+        if (m_pages[i].occupied == 0) {
+            continue;
+        }
+        FilePage record {};
+        record.width = quint32(m_pages[i].image.width());
+        record.height = quint32(m_pages[i].image.height());
+        record.bytesPerLine = record.width * 4;
+        remap[i] = int(pages.size());
+        pages.push_back(record);
+    }
+
+    std::vector<FileEntry> entries;
+    entries.reserve(size_t(m_entries.size()));
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+        const Key &key = it.key();
+        FileEntry record {};
+        record.kind        = quint8(key.kind);
+        record.width       = key.width;
+        record.height      = key.height;
+        record.radius      = key.radius;
+        record.blur        = key.blur;
+        record.dpr         = key.dpr;
+        record.color       = key.color;
+        record.page        = quint32(remap[size_t(it->page)]);
+        record.x           = quint32(it->rect.x());
+        record.y           = quint32(it->rect.y());
+        record.imageWidth  = quint32(it->rect.width());
+        record.imageHeight = quint32(it->rect.height());
+        entries.push_back(record);
+    }
+
+    quint64 offset = alignUp(sizeof(FileHeader) + pages.size() * sizeof(FilePage)
+                             + entries.size() * sizeof(FileEntry));
+    for (FilePage &record : pages) {
+        record.offset = offset;
+        offset = alignUp(offset + quint64(record.bytesPerLine) * record.height);
+    }
+
+    QSaveFile file(m_path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    FileHeader header {};
+    header.magic       = kFileMagic;
+    header.format      = kFileFormat;
+    header.libraryHash = libraryHash();
+    header.pageCount   = quint32(pages.size());
+    header.entryCount  = quint32(entries.size());
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    for (const FilePage &record : pages) {
+        file.write(reinterpret_cast<const char *>(&record), sizeof(record));
+    }
+    for (const FileEntry &record : entries) {
+        file.write(reinterpret_cast<const char *>(&record), sizeof(record));
+    }
+
+    static const char zeros[kBlobAlignment] = {};
+    for (size_t i = 0; i < m_pages.size(); ++i) {
+        if (remap[i] < 0) {
+            continue;
+        }
+        const FilePage &record = pages[size_t(remap[i])];
+        const qint64 gap = qint64(record.offset) - file.pos();
+        if (gap < 0 || gap >= qint64(kBlobAlignment)) {
+            file.cancelWriting();
+            return false;
+        }
+        file.write(zeros, gap);
+        const QImage &image = m_pages[i].image;
+        for (int y = 0; y < image.height(); ++y) {
+            file.write(reinterpret_cast<const char *>(image.constScanLine(y)), image.width() * 4);
+        }
+    }
+
+    releaseMappings();
+    if (!file.commit()) {
+        return false;
+    }
+    m_dirty = false;
+    return true;
+}
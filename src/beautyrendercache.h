@@ -0,0 +1,152 @@
+#pragma once
+
+#include <QColor>
+#include <QHash>
+#include <QHashFunctions>
+#include <QImage>
+#include <QRect>
+#include <QSizeF>
+#include <QString>
+
+#include <memory>
+#include <vector>
+
+class QFile;
+class QPainter;
+
+// Process-wide cache of prerendered widget rasters (drop shadows and pill bodies).
+// Entries are keyed by (size, corner radius, colour, blur, device pixel ratio) and are
+// packed into a few shared atlas pages instead of one small image each. The cache can
+// optionally be persisted to a memory-mapped file so that the next launch does not
+// have to blur the same shadows again.
+class BeautyRenderCache {
+public:
+    enum class Kind : quint8 {
+        Shadow = 1,
+        Body   = 2
+    };
+
+    struct Key {
+        Kind    kind   { Kind::Shadow };
+        quint16 width  { 0 };   // logical pixels
+        quint16 height { 0 };
+        quint16 radius { 0 };   // quarter pixels
+        quint16 blur   { 0 };   // logical pixels
+        quint16 dpr    { 100 }; // percent
+        QRgb    color  { 0 };
+
+        friend bool operator==(const Key &a, const Key &b) {
+            return a.kind == b.kind && a.width == b.width && a.height == b.height
+                && a.radius == b.radius && a.blur == b.blur && a.dpr == b.dpr
+                && a.color == b.color;
+        }
+        friend size_t qHash(const Key &k, size_t seed = 0) {
+            return qHashMulti(seed, quint8(k.kind), k.width, k.height, k.radius,
+                              k.blur, k.dpr, k.color);
+        }
+    };
+
+    // A cached raster: a region of an atlas page. Only valid until the next cache call.
+    struct Raster {
+        QImage page;
+        QRect  source;
+        bool isNull() const { return page.isNull() || source.isEmpty(); }
+    };
+
+    struct Stats {
+        int     pages { 0 };
+        int     entries { 0 };
+        qint64  bytesUsed { 0 };     // memory held by atlas pages
+        qint64  bytesOccupied { 0 }; // part of it covered by live entries
+        qreal   occupancy { 0 };     // bytesOccupied / bytesUsed
+        quint64 hits { 0 };
+        quint64 misses { 0 };
+        quint64 evictions { 0 };
+    };
+
+    static BeautyRenderCache &instance();
+
+    ~BeautyRenderCache();
+
+    // Blurred rounded rect of the given shape, padded by shadowPadding(blur) on every side.
+    Raster shadow(const QSizeF &size, qreal radius, const QColor &color, qreal blur, qreal dpr);
+    // Antialiased filled rounded rect of the given shape.
+    Raster body(const QSizeF &size, qreal radius, const QColor &color, qreal dpr);
+
+    static void draw(QPainter *painter, const QRectF &target, const Raster &raster);
+    static qreal shadowPadding(qreal blur) { return qMax<qreal>(0.0, qRound(blur)); }
+
+    // Opt-in persistence. Loads the file (ignoring it if corrupt or written by another
+    // library version) and saves the cache back to it when the application quits.
+    bool setPersistentFile(const QString &path);
+    QString persistentFile() const { return m_path; }
+    bool save();
+
+    void clear();
+    // Repacks the live entries into as few pages as possible.
+    void defragment();
+    void setMaxBytes(qint64 bytes);
+    qint64 maxBytes() const { return m_maxBytes; }
+    qint64 bytesUsed() const;
+    int entryCount() const { return int(m_entries.size()); }
+    Stats stats() const;
+
+    static quint64 libraryHash();
+
+private:
+    struct Shelf {
+        int y { 0 };
+        int height { 0 };
+        int x { 0 };
+    };
+
+    struct Page {
+        QImage image;
+        std::vector<Shelf> shelves;
+        int     bottom { 0 };     // end of the last shelf
+        qint64  occupied { 0 };
+        quint64 lastUse { 0 };
+        bool    sealed { false }; // loaded from disk or oversized, never packed into
+    };
+
+    struct Mapping {
+        std::unique_ptr<QFile> file;
+        uchar  *base { nullptr };
+        qint64  size { 0 };
+    };
+
+    struct Entry {
+        int     page { -1 };
+        QRect   rect;
+        quint64 lastUse { 0 };
+    };
+
+    BeautyRenderCache();
+    BeautyRenderCache(const BeautyRenderCache &) = delete;
+    BeautyRenderCache &operator=(const BeautyRenderCache &) = delete;
+
+    static Key makeKey(Kind kind, const QSizeF &size, qreal radius, const QColor &color,
+                       qreal blur, qreal dpr);
+    Raster lookup(const Key &key);
+    QImage render(const Key &key) const;
+    Raster insert(const Key &key, const QImage &image);
+    bool allocate(const QSize &size, int *page, QRect *rect);
+    static bool allocateInPage(Page &page, const QSize &size, QRect *rect);
+    void evictPage(int page);
+    void dropEmptyPages();
+    bool load(const QString &path);
+    void releaseMappings();
+
+private:
+    QHash<Key, Entry> m_entries;
+    std::vector<Page> m_pages;
+    std::vector<Mapping> m_mappings;
+    qint64  m_maxBytes;
+    quint64 m_clock { 0 };
+    quint64 m_hits { 0 };
+    quint64 m_misses { 0 };
+    quint64 m_evictions { 0 };
+    QString m_path;
+    bool m_dirty { false };
+    bool m_saveOnQuit { false };
+};
@@ -0,0 +1,94 @@
+#include "beautyshadow.h"
+#include "beautyrendercache.h"
+#include <QPainter>
+#include <QPaintDevice>
+#include <QtMath>
+
+BeautyShadow::BeautyShadow(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void BeautyShadow::setBlurRadius(qreal radius)
+{
+    radius = qMax<qreal>(0.0, radius);
+    if (qFuzzyCompare(m_blurRadius, radius)) {
+        return;
+    }
+    m_blurRadius = radius;
+    emit extentChanged();
+}
+
+void BeautyShadow::setOffset(const QPointF &offset)
+{
+    if (m_offset == offset) {
+        return;
+    }
+    m_offset = offset;
+    emit extentChanged();
+}
+
+void BeautyShadow::setColor(const QColor &color)
+{
+    if (m_color == color) {
+        return;
+    }
+    m_color = color;
+    emit changed();
+}
+
+void BeautyShadow::setShape(const QRectF &rect, qreal cornerRadius)
+{
+    if (m_shape == rect && qFuzzyCompare(m_cornerRadius, cornerRadius)) {
+        return;
+    }
+    m_shape = rect;
+    m_cornerRadius = cornerRadius;
+    emit changed();
+}
+
+void BeautyShadow::setShapeTransform(qreal scale, const QPointF &translate)
+{
+    m_shapeScale = scale;
+    m_shapeTranslate = translate;
+}
+
+// The raster is the shape padded by shadowPadding(blur), scaled around the shape's
+// centre and moved by the shape translation plus the shadow offset.
+qreal BeautyShadow::maxBlurWithin(const QRectF &bounds) const
+{
+    if (m_shape.isEmpty() || m_shapeScale <= 0) {
+        return 0;
+    }
+    const QPointF c = m_shape.center() + m_shapeTranslate + m_offset;
+    const qreal halfW = m_shape.width() / 2.0;
+    const qreal halfH = m_shape.height() / 2.0;
+    const qreal room = qMin(qMin(c.x() - bounds.left(), bounds.right() - c.x()) / m_shapeScale - halfW,
+                            qMin(c.y() - bounds.top(), bounds.bottom() - c.y()) / m_shapeScale - halfH);
+    return qMax<qreal>(0.0, qFloor(room));
+}
+
+void BeautyShadow::draw(QPainter *painter, qreal maxBlur) const
+{
+    const qreal blur = qMin(m_blurRadius, maxBlur);
+    if (blur <= 0 || m_shape.isEmpty() || m_color.alpha() == 0) {
+        return;
+    }
+
+    const qreal dpr = painter->device() ? painter->device()->devicePixelRatio() : 1.0;
+    const BeautyRenderCache::Raster shadow = BeautyRenderCache::instance().shadow(
+        m_shape.size(), m_cornerRadius, m_color, blur, dpr);
+    if (shadow.isNull()) {
+        return;
+    }
+
+    const qreal pad = BeautyRenderCache::shadowPadding(blur);
+    painter->save();
+    painter->setRenderHint(QPainter::SmoothPixmapTransform, true);
+    painter->translate(m_shapeTranslate + m_offset);
+    painter->translate(m_shape.center());
+    painter->scale(m_shapeScale, m_shapeScale);
+    painter->translate(-m_shape.center());
+    BeautyRenderCache::draw(painter, m_shape.adjusted(-pad, -pad, pad, pad), shadow);
+    painter->restore();
+}
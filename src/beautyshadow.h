@@ -0,0 +1,57 @@
+#pragma once
+
+#include <QColor>
+#include <QObject>
+#include <QPointF>
+#include <QRectF>
+
+#include <limits>
+
+class QPainter;
+
+// Drop shadow of a rounded-rect shape: the state the widgets animate, and the cached
+// raster drawn from it. BeautyShadowEffect draws it around a translucent widget; in
+// opaque background mode the widget draws it itself (see BeautyOpaqueBackground).
+class BeautyShadow : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(qreal   blurRadius READ blurRadius WRITE setBlurRadius)
+    Q_PROPERTY(QPointF offset     READ offset     WRITE setOffset)
+    Q_PROPERTY(QColor  color      READ color      WRITE setColor)
+
+public:
+    explicit BeautyShadow(QObject *parent = nullptr);
+
+    qreal   blurRadius() const { return m_blurRadius; }
+    void    setBlurRadius(qreal radius);
+    QPointF offset() const { return m_offset; }
+    void    setOffset(const QPointF &offset);
+    void    setOffset(qreal dx, qreal dy) { setOffset(QPointF(dx, dy)); }
+    QColor  color() const { return m_color; }
+    void    setColor(const QColor &color);
+
+    // Shape that casts the shadow, in widget coordinates, and the scale/translation
+    // the widget currently applies to it.
+    void setShape(const QRectF &rect, qreal cornerRadius);
+    void setShapeTransform(qreal scale, const QPointF &translate);
+
+    // Largest blur whose raster stays inside bounds, after the shadow offset and the
+    // shape transform moved and grew it. Never negative.
+    qreal maxBlurWithin(const QRectF &bounds) const;
+
+    void draw(QPainter *painter, qreal maxBlur = std::numeric_limits<qreal>::max()) const;
+
+signals:
+    // Blur or offset changed, so the area the shadow covers did.
+    void extentChanged();
+    // Colour or shape changed.
+    void changed();
+
+private:
+    qreal   m_blurRadius { 0 };
+    QPointF m_offset { 0, 0 };
+    QColor  m_color { 0, 0, 0, 100 };
+    QRectF  m_shape;
+    qreal   m_cornerRadius { 0 };
+    qreal   m_shapeScale { 1.0 };
+    QPointF m_shapeTranslate { 0, 0 };
+};
@@ -0,0 +1,28 @@
+#include "beautyshadoweffect.h"
+#include "beautyrendercache.h"
+#include <QPainter>
+
+BeautyShadowEffect::BeautyShadowEffect(BeautyShadow *shadow, QObject *parent)
+    : QGraphicsEffect(parent)
+    , m_shadow(shadow)
+{
+    connect(shadow, &BeautyShadow::extentChanged, this, &BeautyShadowEffect::updateBoundingRect);
+    connect(shadow, &BeautyShadow::changed, this, &BeautyShadowEffect::update);
+}
+
+QRectF BeautyShadowEffect::boundingRectFor(const QRectF &rect) const
+{
+    if (!m_shadow) {
+        return rect;
+    }
+    const qreal pad = BeautyRenderCache::shadowPadding(m_shadow->blurRadius()) + 1;
+    return rect.united(rect.translated(m_shadow->offset()).adjusted(-pad, -pad, pad, pad));
+}
+
+void BeautyShadowEffect::draw(QPainter *painter)
+{
+    if (m_shadow) {
+        m_shadow->draw(painter);
+    }
+    drawSource(painter);
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <QGraphicsEffect>
+#include <QPointer>
+#include <QRectF>
+
+#include "beautyshadow.h"
+
+// Draws a BeautyShadow under its widget. Unlike QGraphicsDropShadowEffect, the
+// blurred shadow comes from BeautyRenderCache instead of being re-blurred from the
+// source pixmap on every repaint. The widget animates the BeautyShadow, which it
+// owns; the effect only follows it.
+class BeautyShadowEffect : public QGraphicsEffect {
+    Q_OBJECT
+
+public:
+    explicit BeautyShadowEffect(BeautyShadow *shadow, QObject *parent = nullptr);
+
+    BeautyShadow *shadow() const { return m_shadow; }
+
+    QRectF boundingRectFor(const QRectF &rect) const override;
+
+protected:
+    void draw(QPainter *painter) override;
+
+private:
+    QPointer<BeautyShadow> m_shadow;
+};
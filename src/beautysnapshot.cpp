@@ -0,0 +1,171 @@
+#include "beautysnapshot.h"
+#include "beautyanimationbudget.h"
+#include "beautyshadoweffect.h"
+#include <QGraphicsEffect>
+#include <QPainter>
+#include <QTimerEvent>
+#include <QWidget>
+
+namespace {
+
+int g_idleTimeout = 0;
+
+} // namespace
+
+BeautySnapshot::BeautySnapshot(QWidget *widget)
+    : QObject(widget)
+    , m_widget(widget)
+{
+    syncEnabled();
+}
+
+void BeautySnapshot::setIdleTimeout(int ms)
+{
+    g_idleTimeout = qMax(0, ms);
+}
+
+int BeautySnapshot::idleTimeout()
+{
+    return g_idleTimeout;
+}
+
+bool BeautySnapshot::paintKeyed(size_t key)
+{
+    if (m_rendering) {
+        m_renderKey = key;
+        return false;
+    }
+    if (!m_frozen) {
+        return false;
+    }
+    // Something animates the widget after all (a theme change, a programmatic state
+    // change); paint it live and only take the snapshot once it has settled.
+    if (BeautyAnimationBudget::instance().isAnimating(m_widget)) {
+        if (m_widget->isEnabled()) {
+            wake();
+        }
+        return false;
+    }
+
+    const qreal dpr = m_widget->devicePixelRatioF();
+    if (m_pixmap.isNull() || m_key != key || m_size != m_widget->size() || !qFuzzyCompare(m_dpr, dpr)) {
+        // Taking the snapshot from inside paintEvent would nest a second paint of the
+        // same widget; paint live this once and take it right after the frame.
+        if (!m_capturePending) {
+            m_capturePending = true;
+            QMetaObject::invokeMethod(this, &BeautySnapshot::capture, Qt::QueuedConnection);
+        }
+        return false;
+    }
+
+    QPainter p(m_widget);
+    p.drawPixmap(0, 0, m_pixmap);
+    return true;
+}
+
+void BeautySnapshot::capture()
+{
+    m_capturePending = false;
+    if (!m_frozen || !m_widget->isVisible() || m_widget->size().isEmpty()) {
+        return;
+    }
+
+    const qreal dpr = m_widget->devicePixelRatioF();
+    QPixmap pixmap(m_widget->size() * dpr);
+    pixmap.setDevicePixelRatio(dpr);
+    pixmap.fill(Qt::transparent);
+
+    // The widget's own paintEvent runs inside render() and reports the key it painted.
+    m_rendering = true;
+    m_widget->render(&pixmap, QPoint(), QRegion(), QWidget::RenderFlags());
+    m_rendering = false;
+
+    m_pixmap = pixmap;
+    m_key = m_renderKey;
+    m_size = m_widget->size();
+    m_dpr = dpr;
+}
+
+void BeautySnapshot::wake()
+{
+    if (m_widget->isEnabled()) {
+        setFrozen(false);
+    }
+    restartIdleTimer();
+}
+
+void BeautySnapshot::syncEnabled()
+{
+    if (!m_widget->isEnabled()) {
+        m_idleTimer.stop();
+        setFrozen(true);
+        return;
+    }
+    setFrozen(false);
+    restartIdleTimer();
+}
+
+void BeautySnapshot::effectChanged()
+{
+    syncEffect();
+}
+
+void BeautySnapshot::syncEffect()
+{
+    if (auto *effect = m_widget->graphicsEffect()) {
+        effect->setEnabled(!m_frozen);
+    }
+}
+
+void BeautySnapshot::timerEvent(QTimerEvent *event)
+{
+    if (event->timerId() != m_idleTimer.timerId()) {
+        QObject::timerEvent(event);
+        return;
+    }
+
+    m_idleTimer.stop();
+    if (canIdle()) {
+        setFrozen(true);
+    } else {
+        restartIdleTimer();
+    }
+}
+
+void BeautySnapshot::setFrozen(bool frozen)
+{
+    if (m_frozen == frozen) {
+        return;
+    }
+
+    m_frozen = frozen;
+    syncEffect();
+    if (!frozen) {
+        m_pixmap = QPixmap();
+    }
+}
+
+// Only widgets at rest go idle: nothing hovers, focuses or animates them, and their
+// shadow is not showing, so switching the effect off does not change a pixel.
+bool BeautySnapshot::canIdle() const
+{
+    if (!m_widget->isEnabled() || !m_widget->isVisible() || m_widget->underMouse()
+        || m_widget->hasFocus() || BeautyAnimationBudget::instance().isAnimating(m_widget)) {
+        return false;
+    }
+    QGraphicsEffect *effect = m_widget->graphicsEffect();
+    if (!effect || !effect->isEnabled()) {
+        return true;
+    }
+    const auto *shadow = qobject_cast<BeautyShadowEffect*>(effect);
+    return shadow && (!shadow->shadow() || shadow->shadow()->blurRadius() <= 0);
+}
+
+void BeautySnapshot::restartIdleTimer()
+{
+    if (g_idleTimeout > 0 && m_widget->isEnabled()) {
+        m_idleTimer.start(g_idleTimeout, this);
+    } else {
+        m_idleTimer.stop();
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <QBasicTimer>
+#include <QObject>
+#include <QPixmap>
+#include <QSize>
+
+class QPainter;
+class QWidget;
+
+// Cached rendering of a widget that is not going to animate: disabled widgets, and,
+// once setIdleTimeout() is set, enabled widgets nobody has touched for a while. While
+// frozen, repaints caused by the parent or siblings are a single pixmap blit and the
+// graphics effect is switched off. The owner passes a key describing everything its
+// paintEvent depends on; the snapshot is taken again only when that key, the size or
+// the device pixel ratio changes.
+class BeautySnapshot : public QObject {
+    Q_OBJECT
+
+public:
+    explicit BeautySnapshot(QWidget *widget);
+
+    // Delay after which idle widgets switch to their snapshot; 0 (the default) keeps
+    // enabled widgets on the live paint path.
+    static void setIdleTimeout(int ms);
+    static int  idleTimeout();
+
+    // Call at the start of paintEvent with a callable returning the key. Returns true if
+    // the widget was painted from the snapshot and the caller should return. The key is
+    // only computed while frozen or while the snapshot is taken, never on live frames.
+    template <typename KeyFunction>
+    bool paint(KeyFunction key)
+    {
+        if (!m_frozen && !m_rendering) {
+            return false;
+        }
+        return paintKeyed(key());
+    }
+    // Leaves the idle state, e.g. on hover or focus, and restarts the idle countdown.
+    void wake();
+    // Call after the widget handled an EnabledChange.
+    void syncEnabled();
+    // Call after the owner installed or removed its graphics effect. Frozen widgets
+    // keep it switched off.
+    void effectChanged();
+    bool isFrozen() const { return m_frozen; }
+
+protected:
+    void timerEvent(QTimerEvent *event) override;
+
+private:
+    bool paintKeyed(size_t key);
+    void setFrozen(bool frozen);
+    void syncEffect();
+    bool canIdle() const;
+    void capture();
+    void restartIdleTimer();
+
+private:
+    QWidget *m_widget;
+    QPixmap m_pixmap;
+    QSize   m_size;
+    qreal   m_dpr { 1.0 };
+    size_t  m_key { 0 };
+    size_t  m_renderKey { 0 };
+    QBasicTimer m_idleTimer;
+    bool m_frozen { false };
+    bool m_rendering { false };
+    bool m_capturePending { false };
+};
@@ -0,0 +1,284 @@
+#include "stresspage.h"
+
+#include <QCheckBox>
+#include <QEnterEvent>
+#include <QFontDatabase>
+#include <QGridLayout>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPainter>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QStringList>
+#include <QTimer>
+#include <QVBoxLayout>
+
+#include <iterator>
+
+#include "beautyanimationbudget.h"
+#include "beautyiconcache.h"
+#include "beautylineedit.h"
+#include "beautypushbutton.h"
+#include "beautyrendercache.h"
+#include "eventtrace.h"
+
+namespace {
+
+constexpr int kOverlayInterval = 500; // ms
+constexpr int kHoverInterval = 30;
+constexpr int kFocusInterval = 120;
+constexpr int kThemeInterval = 1000;
+constexpr int kMaxCells = 60;
+
+const QColor kThemes[] = {
+    QColor(210, 245, 210),
+    QColor(200, 225, 250),
+    QColor(250, 220, 200),
+    QColor(235, 215, 245),
+    QColor(245, 240, 195),
+};
+
+QString megabytes(qint64 bytes)
+{
+    return QString::number(bytes / (1024.0 * 1024.0), 'f', 1) + QStringLiteral(" MB");
+}
+
+} // namespace
+
+PerfOverlay::PerfOverlay(EventTraceApplication *app, QWidget *parent)
+    : QWidget(parent)
+    , m_app(app)
+    , m_timer(new QTimer(this))
+{
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+    setFocusPolicy(Qt::NoFocus);
+    setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+
+    m_app->setFrameObserver([this](qint64 nanos) {
+        ++m_frames;
+        m_frameNanos += nanos;
+    });
+
+    connect(m_timer, &QTimer::timeout, this, &PerfOverlay::refresh);
+    m_timer->start(kOverlayInterval);
+    m_window.start();
+    refresh();
+}
+
+PerfOverlay::~PerfOverlay()
+{
+    m_app->setFrameObserver(nullptr);
+}
+
+void PerfOverlay::refresh()
+{
+    const qint64 elapsed = qMax<qint64>(1, m_window.restart());
+    const qreal fps = m_frames * 1000.0 / elapsed;
+    const qreal paintMs = m_frames ? m_frameNanos / 1e6 / m_frames : 0.0;
+    m_frames = 0;
+    m_frameNanos = 0;
+
+    const BeautyAnimationBudget::Stats anim = BeautyAnimationBudget::instance().stats();
+    const BeautyRenderCache::Stats cache = BeautyRenderCache::instance().stats();
+    const quint64 lookups = cache.hits + cache.misses;
+
+    QStringList lines;
+    lines << QStringLiteral("FPS         %1").arg(fps, 0, 'f', 1)
+          << QStringLiteral("paint       %1 ms/frame").arg(paintMs, 0, 'f', 2)
+          << QStringLiteral("animations  %1 (peak %2, budget %3)")
+                 .arg(anim.active).arg(anim.peak)
+                 .arg(anim.budget ? QString::number(anim.budget) : QStringLiteral("-"))
+          << QStringLiteral("render cache %1, %2 pages, %3 entries, %4% hits")
+                 .arg(megabytes(cache.bytesUsed)).arg(cache.pages).arg(cache.entries)
+                 .arg(lookups ? 100.0 * cache.hits / lookups : 0.0, 0, 'f', 0)
+          << QStringLiteral("icon cache  %1").arg(megabytes(BeautyIconCache::instance().bytesUsed()));
+    m_text = lines.join(QLatin1Char('\n'));
+
+    const QRect bounds = fontMetrics().boundingRect(QRect(0, 0, 2000, 2000), Qt::AlignLeft, m_text);
+    resize(bounds.size() + QSize(16, 12));
+    reposition();
+    update();
+}
+
+void PerfOverlay::reposition()
+{
+    if (const QWidget *parent = parentWidget()) {
+        move(parent->width() - width() - 8, parent->height() - height() - 8);
+    }
+}
+
+void PerfOverlay::paintEvent(QPaintEvent *)
+{
+    QPainter p(this);
+    p.setRenderHint(QPainter::Antialiasing);
+    p.setPen(Qt::NoPen);
+    p.setBrush(QColor(0, 0, 0, 170));
+    p.drawRoundedRect(rect(), 6, 6);
+    p.setPen(Qt::white);
+    p.drawText(rect().adjusted(8, 6, -8, -6), Qt::AlignLeft | Qt::AlignTop, m_text);
+}
+
+StressPage::StressPage(EventTraceApplication *app, int columns, int rows, QWidget *parent)
+    : QWidget(parent)
+    , m_columns(new QSpinBox(this))
+    , m_rows(new QSpinBox(this))
+    , m_hoverSweep(new QCheckBox(QStringLiteral("Hover sweep"), this))
+    , m_focusSweep(new QCheckBox(QStringLiteral("Focus sweep"), this))
+    , m_themeCycle(new QCheckBox(QStringLiteral("Cycle themes"), this))
+    , m_grid(new QWidget(this))
+    , m_gridLayout(new QGridLayout(m_grid))
+    , m_overlay(nullptr)
+    , m_hoverTimer(new QTimer(this))
+    , m_focusTimer(new QTimer(this))
+    , m_themeTimer(new QTimer(this))
+{
+    setWindowTitle(QStringLiteral("BeautyWidgets Stress"));
+
+    m_columns->setRange(1, kMaxCells);
+    m_columns->setValue(columns);
+    m_columns->setObjectName(QStringLiteral("stressColumns"));
+    m_rows->setRange(1, kMaxCells);
+    m_rows->setValue(rows);
+    m_rows->setObjectName(QStringLiteral("stressRows"));
+    m_hoverSweep->setObjectName(QStringLiteral("stressHoverSweep"));
+    m_focusSweep->setObjectName(QStringLiteral("stressFocusSweep"));
+    m_themeCycle->setObjectName(QStringLiteral("stressThemeCycle"));
+    auto *rebuildButton = new QPushButton(QStringLiteral("Rebuild"), this);
+    rebuildButton->setObjectName(QStringLiteral("stressRebuild"));
+
+    auto *controls = new QHBoxLayout;
+    controls->addWidget(new QLabel(QStringLiteral("Columns"), this));
+    controls->addWidget(m_columns);
+    controls->addWidget(new QLabel(QStringLiteral("Rows"), this));
+    controls->addWidget(m_rows);
+    controls->addWidget(rebuildButton);
+    controls->addSpacing(12);
+    controls->addWidget(m_hoverSweep);
+    controls->addWidget(m_focusSweep);
+    controls->addWidget(m_themeCycle);
+    controls->addStretch();
+
+    m_gridLayout->setSpacing(2);
+    m_gridLayout->setContentsMargins(0, 0, 0, 0);
+
+    auto *layout = new QVBoxLayout(this);
+    layout->addLayout(controls);
+    layout->addWidget(m_grid, 1);
+
+    m_hoverTimer->setInterval(kHoverInterval);
+    m_focusTimer->setInterval(kFocusInterval);
+    m_themeTimer->setInterval(kThemeInterval);
+    connect(m_hoverTimer, &QTimer::timeout, this, &StressPage::hoverStep);
+    connect(m_focusTimer, &QTimer::timeout, this, &StressPage::focusStep);
+    connect(m_themeTimer, &QTimer::timeout, this, &StressPage::themeStep);
+    connect(m_hoverSweep, &QCheckBox::toggled, this, [this](bool on) {
+        if (on) {
+            m_hoverTimer->start();
+        } else {
+            m_hoverTimer->stop();
+            hoverStep(); // leave the last hovered cell
+            m_hoverIndex = -1;
+        }
+    });
+    connect(m_focusSweep, &QCheckBox::toggled, m_focusTimer, [this](bool on) {
+        on ? m_focusTimer->start() : m_focusTimer->stop();
+    });
+    connect(m_themeCycle, &QCheckBox::toggled, m_themeTimer, [this](bool on) {
+        on ? m_themeTimer->start() : m_themeTimer->stop();
+    });
+    connect(rebuildButton, &QPushButton::clicked, this, &StressPage::rebuild);
+
+    m_overlay = new PerfOverlay(app, this);
+    rebuild();
+}
+
+void StressPage::rebuild()
+{
+    m_hoverIndex = -1;
+    m_focusIndex = -1;
+    for (const QPointer<QWidget> &cell : std::as_const(m_cells)) {
+        delete cell.data();
+    }
+    m_cells.clear();
+
+    const int columns = m_columns->value();
+    const int rows = m_rows->value();
+    m_cells.reserve(columns * rows);
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < columns; ++c) {
+            QWidget *cell;
+            if ((r + c) % 2 == 0) {
+                auto *button = new BeautyPushButton(m_grid);
+                button->setText(QStringLiteral("%1,%2").arg(r).arg(c));
+                button->setObjectName(QStringLiteral("stressButton_%1_%2").arg(r).arg(c));
+                cell = button;
+            } else {
+                auto *edit = new BeautyLineEdit(m_grid);
+                edit->setObjectName(QStringLiteral("stressEdit_%1_%2").arg(r).arg(c));
+                edit->setPlaceholderText(QStringLiteral("%1,%2").arg(r).arg(c));
+                cell = edit;
+            }
+            m_gridLayout->addWidget(cell, r, c);
+            m_cells.append(cell);
+        }
+    }
+    if (m_themeIndex) {
+        --m_themeIndex;
+        themeStep();
+    }
+    m_overlay->raise();
+}
+
+void StressPage::hoverStep()
+{
+    if (m_hoverIndex >= 0 && m_hoverIndex < m_cells.size()) {
+        if (QWidget *previous = m_cells.at(m_hoverIndex)) {
+            previous->setAttribute(Qt::WA_UnderMouse, false);
+            QEvent leave(QEvent::Leave);
+            QCoreApplication::sendEvent(previous, &leave);
+        }
+    }
+    if (!m_hoverTimer->isActive() || m_cells.isEmpty()) {
+        return;
+    }
+
+    m_hoverIndex = (m_hoverIndex + 1) % m_cells.size();
+    if (QWidget *next = m_cells.at(m_hoverIndex)) {
+        const QPointF local = QRectF(next->rect()).center();
+        next->setAttribute(Qt::WA_UnderMouse, true);
+        QEnterEvent enter(local, next->window()->mapFromGlobal(next->mapToGlobal(local)),
+                          next->mapToGlobal(local));
+        QCoreApplication::sendEvent(next, &enter);
+    }
+}
+
+void StressPage::focusStep()
+{
+    for (int i = 0; i < m_cells.size(); ++i) {
+        m_focusIndex = (m_focusIndex + 1) % m_cells.size();
+        QWidget *next = m_cells.at(m_focusIndex);
+        if (next && (next->focusPolicy() & Qt::TabFocus)) {
+            next->setFocus(Qt::TabFocusReason);
+            return;
+        }
+    }
+}
+
+void StressPage::themeStep()
+{
+    m_themeIndex = (m_themeIndex + 1) % int(std::size(kThemes));
+    const QColor theme = kThemes[m_themeIndex];
+    for (const QPointer<QWidget> &cell : std::as_const(m_cells)) {
+        if (auto *button = qobject_cast<BeautyPushButton *>(cell)) {
+            button->setThemeColor(theme);
+        } else if (auto *edit = qobject_cast<BeautyLineEdit *>(cell)) {
+            edit->setThemeColor(theme);
+        }
+    }
+}
+
+void StressPage::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    m_overlay->reposition();
+}
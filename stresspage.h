@@ -0,0 +1,74 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QPointer>
+#include <QWidget>
+
+class QCheckBox;
+class QGridLayout;
+class QLabel;
+class QSpinBox;
+class QTimer;
+class EventTraceApplication;
+
+// Live FPS / paint cost / animation / cache readout drawn on top of the stress page.
+class PerfOverlay final : public QWidget {
+    Q_OBJECT
+
+public:
+    PerfOverlay(EventTraceApplication *app, QWidget *parent);
+    ~PerfOverlay() override;
+
+    // Keeps the overlay in the bottom right corner of its parent.
+    void reposition();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    void refresh();
+
+private:
+    EventTraceApplication *m_app;
+    QTimer *m_timer;
+    QElapsedTimer m_window;
+    int     m_frames { 0 };
+    qint64  m_frameNanos { 0 };
+    QString m_text;
+};
+
+// Grid of N x M Beauty widgets with automated hover and focus sweeps and theme
+// cycling, for judging a release on the target hardware.
+class StressPage final : public QWidget {
+    Q_OBJECT
+
+public:
+    StressPage(EventTraceApplication *app, int columns, int rows, QWidget *parent = nullptr);
+
+protected:
+    void resizeEvent(QResizeEvent *event) override;
+
+private:
+    void rebuild();
+    void hoverStep();
+    void focusStep();
+    void themeStep();
+
+private:
+    QSpinBox *m_columns;
+    QSpinBox *m_rows;
+    QCheckBox *m_hoverSweep;
+    QCheckBox *m_focusSweep;
+    QCheckBox *m_themeCycle;
+    QWidget *m_grid;
+    QGridLayout *m_gridLayout;
+    PerfOverlay *m_overlay;
+    QTimer *m_hoverTimer;
+    QTimer *m_focusTimer;
+    QTimer *m_themeTimer;
+    QList<QPointer<QWidget>> m_cells;
+    int m_hoverIndex { -1 };
+    int m_focusIndex { -1 };
+    int m_themeIndex { 0 };
+};
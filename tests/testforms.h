@@ -0,0 +1,74 @@
+#pragma once
+
+#include <QDataStream>
+#include <QFile>
+#include <QLabel>
+#include <QRegularExpression>
+#include <QVBoxLayout>
+
+#include <memory>
+
+#include "beautylineedit.h"
+#include "beautypushbutton.h"
+#include "eventtrace.h"
+
+// Fixtures shared by the event trace tests: a small form with a label, a line edit and
+// a button named "form", "label", "edit" and "button", and readers for what the
+// recorder and the replayer write.
+
+// opaque puts the Beauty widgets in opaque mode on the form's window colour.
+inline std::unique_ptr<QWidget> makeForm(bool opaque = false)
+{
+    auto form = std::make_unique<QWidget>();
+    form->setObjectName(QStringLiteral("form"));
+    auto *layout = new QVBoxLayout(form.get());
+    auto *label = new QLabel(QStringLiteral("Name"), form.get());
+    label->setObjectName(QStringLiteral("label"));
+    auto *edit = new BeautyLineEdit(form.get());
+    edit->setObjectName(QStringLiteral("edit"));
+    auto *button = new BeautyPushButton(form.get());
+    button->setObjectName(QStringLiteral("button"));
+    button->setText(QStringLiteral("OK"));
+    if (opaque) {
+        const QColor background = form->palette().color(QPalette::Window);
+        edit->setOpaqueBackground(background);
+        button->setOpaqueBackground(background);
+    }
+    layout->addWidget(label);
+    layout->addWidget(edit);
+    layout->addWidget(button);
+    form->resize(320, 160);
+    return form;
+}
+
+inline QList<TraceEvent> readTrace(const QString &path)
+{
+    QList<TraceEvent> events;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return events;
+    }
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint32 version = 0;
+    in >> magic >> version;
+    while (!in.atEnd()) {
+        TraceEvent e;
+        in >> e;
+        if (in.status() != QDataStream::Ok) {
+            break;
+        }
+        events.append(e);
+    }
+    return events;
+}
+
+// Paint count of one widget in a replay report; widgets that never painted are not listed.
+inline quint64 paintsOf(const QString &report, const QString &widget)
+{
+    const QRegularExpression line(QStringLiteral("^  %1: (\\d+)$").arg(QRegularExpression::escape(widget)),
+                                  QRegularExpression::MultilineOption);
+    const QRegularExpressionMatch match = line.match(report);
+    return match.hasMatch() ? match.captured(1).toULongLong() : 0;
+}
@@ -0,0 +1,262 @@
+#include <QtMath>
+#include <QtTest>
+
+#include <algorithm>
+#include <vector>
+
+#include "beautyblur.h"
+
+namespace {
+
+using Mask = std::vector<uchar>;
+
+// Opaque rectangle inside a transparent border, the shape a shadow is blurred from.
+// Widths are deliberately not multiples of the vector widths, to cover the tails.
+Mask shadowMask(int width, int height, int padding)
+{
+    Mask mask(size_t(width) * size_t(height), 0);
+    for (int y = padding; y < height - padding; ++y) {
+        for (int x = padding; x < width - padding; ++x) {
+            mask[size_t(y) * size_t(width) + size_t(x)] = 255;
+        }
+    }
+    return mask;
+}
+
+// Direct separable convolution with a sampled Gaussian, zero outside the plane.
+std::vector<double> gaussianReference(const Mask &src, int width, int height, qreal sigma)
+{
+    const int r = qCeil(3.0 * sigma);
+    std::vector<double> kernel(size_t(2 * r + 1));
+    double total = 0;
+    for (int i = -r; i <= r; ++i) {
+        kernel[size_t(i + r)] = qExp(-(i * i) / (2.0 * sigma * sigma));
+        total += kernel[size_t(i + r)];
+    }
+    for (double &k : kernel) {
+        k /= total;
+    }
+
+    std::vector<double> rows(src.size());
+    std::vector<double> out(src.size());
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            double acc = 0;
+            for (int i = -r; i <= r; ++i) {
+                if (x + i >= 0 && x + i < width) {
+                    acc += kernel[size_t(i + r)] * src[size_t(y * width + x + i)];
+                }
+            }
+            rows[size_t(y * width + x)] = acc;
+        }
+    }
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            double acc = 0;
+            for (int i = -r; i <= r; ++i) {
+                if (y + i >= 0 && y + i < height) {
+                    acc += kernel[size_t(i + r)] * rows[size_t((y + i) * width + x)];
+                }
+            }
+            out[size_t(y * width + x)] = acc;
+        }
+    }
+    return out;
+}
+
+QList<BeautyBlur::Backend> supportedBackends()
+{
+    QList<BeautyBlur::Backend> backends;
+    for (auto b : { BeautyBlur::Backend::Scalar, BeautyBlur::Backend::Sse2, BeautyBlur::Backend::Avx2 }) {
+        if (int(b) <= int(BeautyBlur::bestBackend())) {
+            backends.append(b);
+        }
+    }
+    return backends;
+}
+
+const char *backendName(BeautyBlur::Backend backend)
+{
+    switch (backend) {
+    case BeautyBlur::Backend::Sse2:
+        return "sse2";
+    case BeautyBlur::Backend::Avx2:
+        return "avx2";
+    default:
+        return "scalar";
+    }
+}
+
+Mask blurred(const Mask &src, int width, int height, qreal sigma, BeautyBlur::Backend backend)
+{
+    BeautyBlur::setBackend(backend);
+    Mask out = src;
+    BeautyBlur::blurAlpha(out.data(), width, height, width, sigma);
+    return out;
+}
+
+} // namespace
+
+class TestBeautyBlur : public QObject {
+    Q_OBJECT
+
+private slots:
+    void cleanup();
+    void backendsAgree_data();
+    void backendsAgree();
+    void matchesGaussian_data();
+    void matchesGaussian();
+    void benchmark_data();
+    void benchmark();
+};
+
+void TestBeautyBlur::cleanup()
+{
+    BeautyBlur::setBackend(BeautyBlur::bestBackend());
+}
+
+void TestBeautyBlur::backendsAgree_data()
+{
+    QTest::addColumn<int>("radius");
+    for (int radius = 1; radius <= 30; ++radius) {
+        QTest::addRow("r=%d", radius) << radius;
+    }
+}
+
+// The vector kernels do the same integer arithmetic as the scalar ones, so the
+// results have to be identical, not just close.
+void TestBeautyBlur::backendsAgree()
+{
+    QFETCH(int, radius);
+    const int padding = radius + 2;
+    const int width = 117 + 2 * padding;
+    const int height = 37 + 2 * padding;
+    const qreal sigma = BeautyBlur::sigmaForRadius(radius);
+    const Mask mask = shadowMask(width, height, padding);
+
+    const Mask reference = blurred(mask, width, height, sigma, BeautyBlur::Backend::Scalar);
+    for (BeautyBlur::Backend backend : supportedBackends()) {
+        const Mask result = blurred(mask, width, height, sigma, backend);
+        QVERIFY2(result == reference, backendName(backend));
+    }
+}
+
+namespace {
+
+// Measured error of the triple box blur against the Gaussian on this mask, plus one
+// alpha level for the maximum and 0.2 for the mean. Three boxes cannot follow
+// a Gaussian narrower than about two pixels: the box widths are odd integers, so the
+// variance is off by up to 50% at the small radii.
+struct ErrorBound {
+    double max;
+    double mean;
+};
+
+const ErrorBound kGaussianError[] = {
+    { 7.0, 0.55 }, // r=1
+    { 51.0, 4.10 }, // r=2
+    { 30.0, 2.70 }, // r=3
+    { 13.0, 1.60 }, // r=4
+    { 19.5, 2.40 }, // r=5
+    { 8.5, 1.35 }, // r=6
+    { 12.0, 1.85 }, // r=7
+    { 14.0, 2.20 }, // r=8
+    { 5.5, 1.15 }, // r=9
+    { 11.5, 1.95 }, // r=10
+    { 12.5, 2.10 }, // r=11
+    { 4.5, 1.15 }, // r=12
+    { 11.0, 1.90 }, // r=13
+    { 11.0, 2.00 }, // r=14
+    { 5.0, 1.20 }, // r=15
+    { 10.0, 2.00 }, // r=16
+    { 11.0, 2.05 }, // r=17
+    { 6.0, 1.25 }, // r=18
+    { 10.5, 1.95 }, // r=19
+    { 10.0, 2.00 }, // r=20
+    { 6.0, 1.30 }, // r=21
+    { 9.5, 1.85 }, // r=22
+    { 9.5, 1.90 }, // r=23
+    { 6.0, 1.25 }, // r=24
+    { 9.5, 1.80 }, // r=25
+    { 9.5, 1.80 }, // r=26
+    { 6.0, 1.30 }, // r=27
+    { 9.5, 1.85 }, // r=28
+    { 9.5, 1.85 }, // r=29
+    { 6.5, 1.40 }, // r=30
+};
+
+} // namespace
+
+void TestBeautyBlur::matchesGaussian_data()
+{
+    QTest::addColumn<int>("radius");
+    QTest::addColumn<double>("maxError");
+    QTest::addColumn<double>("meanError");
+    for (int radius = 1; radius <= 30; ++radius) {
+        const ErrorBound &bound = kGaussianError[radius - 1];
+        QTest::addRow("r=%d", radius) << radius << bound.max << bound.mean;
+    }
+}
+
+void TestBeautyBlur::matchesGaussian()
+{
+    QFETCH(int, radius);
+    QFETCH(double, maxError);
+    QFETCH(double, meanError);
+    const int padding = radius + 2;
+    const int width = 117 + 2 * padding;
+    const int height = 37 + 2 * padding;
+    const qreal sigma = BeautyBlur::sigmaForRadius(radius);
+    const Mask mask = shadowMask(width, height, padding);
+    const std::vector<double> reference = gaussianReference(mask, width, height, sigma);
+
+    for (BeautyBlur::Backend backend : supportedBackends()) {
+        const Mask result = blurred(mask, width, height, sigma, backend);
+        double worst = 0;
+        double total = 0;
+        for (size_t i = 0; i < result.size(); ++i) {
+            const double error = qAbs(result[i] - reference[i]);
+            worst = qMax(worst, error);
+            total += error;
+        }
+        const double mean = total / double(result.size());
+        QVERIFY2(worst <= maxError, qPrintable(QStringLiteral("%1: max error %2")
+                                               .arg(QLatin1String(backendName(backend))).arg(worst)));
+        QVERIFY2(mean <= meanError, qPrintable(QStringLiteral("%1: mean error %2")
+                                               .arg(QLatin1String(backendName(backend))).arg(mean)));
+    }
+}
+
+void TestBeautyBlur::benchmark_data()
+{
+    QTest::addColumn<int>("backend");
+    QTest::addColumn<int>("radius");
+    for (BeautyBlur::Backend backend : supportedBackends()) {
+        for (int radius = 0; radius <= 30; ++radius) {
+            QTest::addRow("%s r=%d", backendName(backend), radius) << int(backend) << radius;
+        }
+    }
+}
+
+// A 160x40 button shadow, padded by the blur radius like BeautyRenderCache does.
+void TestBeautyBlur::benchmark()
+{
+    QFETCH(int, backend);
+    QFETCH(int, radius);
+    const int width = 160 + 2 * radius;
+    const int height = 40 + 2 * radius;
+    const qreal sigma = BeautyBlur::sigmaForRadius(radius);
+    const Mask source = shadowMask(width, height, radius);
+    Mask mask(source.size());
+
+    // The blur works in place; every iteration starts again from the unblurred mask.
+    BeautyBlur::setBackend(BeautyBlur::Backend(backend));
+    QBENCHMARK {
+        std::copy(source.cbegin(), source.cend(), mask.begin());
+        BeautyBlur::blurAlpha(mask.data(), width, height, width, sigma);
+    }
+}
+
+QTEST_APPLESS_MAIN(TestBeautyBlur)
+
+#include "tst_beautyblur.moc"
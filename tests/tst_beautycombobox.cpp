@@ -0,0 +1,112 @@
+#include <QAbstractItemView>
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QLineEdit>
+#include <QSet>
+#include <QStringListModel>
+#include <QtTest>
+
+#include "beautycombobox.h"
+
+namespace {
+
+constexpr int kRows = 200000;
+
+// Records which rows anything read, to show what opening the popup costs.
+class CountingModel : public QStringListModel {
+public:
+    explicit CountingModel(const QStringList &rows)
+        : QStringListModel(rows)
+    {
+    }
+
+    QVariant data(const QModelIndex &index, int role) const override
+    {
+        touched.insert(index.row());
+        return QStringListModel::data(index, role);
+    }
+
+    mutable QSet<int> touched;
+};
+
+QStringList manyRows()
+{
+    QStringList rows;
+    rows.reserve(kRows);
+    for (int i = 0; i < kRows; ++i) {
+        rows.append(QStringLiteral("Item %1").arg(i, 6, 10, QLatin1Char('0')));
+    }
+    return rows;
+}
+
+} // namespace
+
+class TestBeautyComboBox : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void popupReadsVisibleRowsOnly();
+    void showPopupBenchmark();
+    void editableTakesTyping();
+};
+
+// Fusion asks for the popup-style combo, the expensive path of QComboBox::showPopup().
+void TestBeautyComboBox::initTestCase()
+{
+    QApplication::setStyle(QStringLiteral("Fusion"));
+}
+
+void TestBeautyComboBox::popupReadsVisibleRowsOnly()
+{
+    CountingModel model(manyRows());
+    BeautyComboBox combo;
+    combo.setModel(&model);
+    combo.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&combo));
+
+    model.touched.clear();
+    QElapsedTimer timer;
+    timer.start();
+    combo.showPopup();
+    const qint64 ms = timer.elapsed();
+    QVERIFY(combo.view()->isVisible());
+    qInfo("showPopup over %d rows: %lld ms, %lld rows read", kRows, ms, qint64(model.touched.size()));
+    QVERIFY2(model.touched.size() <= 1000, qPrintable(QString::number(model.touched.size())));
+    combo.hidePopup();
+}
+
+void TestBeautyComboBox::showPopupBenchmark()
+{
+    QStringListModel model(manyRows());
+    BeautyComboBox combo;
+    combo.setModel(&model);
+    combo.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&combo));
+
+    QBENCHMARK {
+        combo.showPopup();
+        combo.hidePopup();
+    }
+}
+
+// Keys typed into an editable combo reach its line edit instead of starting a search.
+void TestBeautyComboBox::editableTakesTyping()
+{
+    QStringListModel model(QStringList { QStringLiteral("alpha"), QStringLiteral("beta") });
+    BeautyComboBox combo;
+    combo.setEditable(true);
+    combo.setModel(&model);
+    combo.setCompleter(nullptr);
+    combo.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&combo));
+
+    combo.lineEdit()->clear();
+    QTest::keyClicks(&combo, QStringLiteral("bet"));
+    QCOMPARE(combo.lineEdit()->text(), QStringLiteral("bet"));
+    QCOMPARE(combo.currentIndex(), 0);
+}
+
+QTEST_MAIN(TestBeautyComboBox)
+
+#include "tst_beautycombobox.moc"
@@ -0,0 +1,182 @@
+#include <QFile>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include "beautyshadow.h"
+#include "testforms.h"
+
+namespace {
+
+TraceEvent traced(QEvent::Type type, const QString &target, const QPointF &pos = QPointF())
+{
+    TraceEvent e;
+    e.type = quint16(type);
+    e.target = target;
+    e.pos = pos;
+    return e;
+}
+
+TraceEvent clicked(QEvent::Type type, const QString &target, const QPointF &pos)
+{
+    TraceEvent e = traced(type, target, pos);
+    e.button = Qt::LeftButton;
+    e.buttons = type == QEvent::MouseButtonPress ? Qt::LeftButton : Qt::NoButton;
+    return e;
+}
+
+TraceEvent typed(QEvent::Type type, const QString &target, QChar c)
+{
+    TraceEvent e = traced(type, target);
+    e.key = Qt::Key_A + (c.unicode() - 'a');
+    e.text = QString(c);
+    return e;
+}
+
+// Hovers the button, leaves it for the label, then clicks into the line edit and types.
+QList<TraceEvent> hoverAndTyping()
+{
+    const QString button = QStringLiteral("button");
+    const QString label = QStringLiteral("label");
+    const QString edit = QStringLiteral("edit");
+    TraceEvent focus = traced(QEvent::FocusIn, edit);
+    focus.focusReason = quint8(Qt::MouseFocusReason);
+    QList<TraceEvent> events {
+        traced(QEvent::Enter, button, QPointF(20, 10)),
+        traced(QEvent::MouseMove, button, QPointF(20, 10)),
+        traced(QEvent::MouseMove, button, QPointF(40, 14)),
+        traced(QEvent::Leave, button),
+        traced(QEvent::Enter, label, QPointF(10, 5)),
+        traced(QEvent::MouseMove, label, QPointF(10, 5)),
+        traced(QEvent::Leave, label),
+        traced(QEvent::Enter, edit, QPointF(20, 10)),
+        clicked(QEvent::MouseButtonPress, edit, QPointF(20, 10)),
+        focus,
+        clicked(QEvent::MouseButtonRelease, edit, QPointF(20, 10)),
+    };
+    for (QChar c : QStringLiteral("abc")) {
+        events.append(typed(QEvent::KeyPress, edit, c));
+        events.append(typed(QEvent::KeyRelease, edit, c));
+    }
+    return events;
+}
+
+} // namespace
+
+class TestBeautyOpaque : public QObject {
+    Q_OBJECT
+
+public:
+    explicit TestBeautyOpaque(EventTraceApplication *app)
+        : m_app(app)
+    {
+    }
+
+private slots:
+    void initTestCase();
+    void replayRepaintsOnlyTheWidgets_data();
+    void replayRepaintsOnlyTheWidgets();
+    void translucentDefaultRestored();
+    void shadowCapLeavesRoomForOffsetAndScale();
+
+private:
+    EventTraceApplication *m_app;
+    QTemporaryDir m_dir;
+};
+
+void TestBeautyOpaque::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+}
+
+void TestBeautyOpaque::replayRepaintsOnlyTheWidgets_data()
+{
+    QTest::addColumn<bool>("opaque");
+    QTest::newRow("translucent") << false;
+    QTest::newRow("opaque") << true;
+}
+
+void TestBeautyOpaque::replayRepaintsOnlyTheWidgets()
+{
+    QFETCH(bool, opaque);
+    auto form = makeForm(opaque);
+    form->show();
+    QVERIFY(QTest::qWaitForWindowActive(form.get()));
+
+    const QString mode = QString::fromLatin1(QTest::currentDataTag());
+    const QString reportPath = m_dir.filePath(mode + QStringLiteral(".txt"));
+    // Fast replay: the replayer dispatches the events back to back, then waits for the
+    // animation budget to go idle before it writes the report.
+    EventReplayer replayer(form.get(), m_app);
+    replayer.setEvents(hoverAndTyping());
+    QSignalSpy finished(&replayer, &EventReplayer::finished);
+    replayer.start(false, reportPath);
+    QVERIFY(finished.count() == 1 || finished.wait(5000));
+    QCOMPARE(finished.at(0).at(0).toBool(), true);
+
+    QFile file(reportPath);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QString report = QString::fromUtf8(file.readAll());
+    const quint64 parent = paintsOf(report, QStringLiteral("form"));
+    const quint64 sibling = paintsOf(report, QStringLiteral("label"));
+    const quint64 button = paintsOf(report, QStringLiteral("button"));
+    const quint64 edit = paintsOf(report, QStringLiteral("edit"));
+    qInfo("%s: form %llu, label %llu, button %llu, edit %llu paints", qPrintable(mode),
+          parent, sibling, button, edit);
+
+    QVERIFY(button > 0);
+    QVERIFY(edit > 0);
+    if (opaque) {
+        QCOMPARE(parent, quint64(0));
+        QCOMPARE(sibling, quint64(0));
+    } else {
+        // The harness does see the parent repaints the opaque mode avoids.
+        QVERIFY(parent > 0);
+    }
+}
+
+void TestBeautyOpaque::translucentDefaultRestored()
+{
+    BeautyPushButton button;
+    QVERIFY(button.graphicsEffect());
+
+    button.setOpaqueBackground(QColor(10, 20, 30, 40));
+    QCOMPARE(button.opaqueBackground(), QColor(10, 20, 30));
+    QVERIFY(!button.graphicsEffect());
+    QVERIFY(button.testAttribute(Qt::WA_OpaquePaintEvent));
+    QVERIFY(!button.testAttribute(Qt::WA_TranslucentBackground));
+
+    button.setOpaqueBackground(QColor());
+    QVERIFY(!button.opaqueBackground().isValid());
+    QVERIFY(button.graphicsEffect());
+    QVERIFY(!button.testAttribute(Qt::WA_OpaquePaintEvent));
+    QVERIFY(button.testAttribute(Qt::WA_TranslucentBackground));
+}
+
+// A 100x40 button with a 6px margin, hovered: scaled by 1.01, floated by (2, 1) and
+// casting its shadow 3px down. Only 1px of blur fits under the bottom edge.
+void TestBeautyOpaque::shadowCapLeavesRoomForOffsetAndScale()
+{
+    const QRectF bounds(0, 0, 100, 40);
+    BeautyShadow shadow;
+    shadow.setShape(bounds.adjusted(6, 6, -6, -6), 8);
+    QCOMPARE(shadow.maxBlurWithin(bounds), 6.0);
+
+    shadow.setOffset(0, 3);
+    QCOMPARE(shadow.maxBlurWithin(bounds), 3.0);
+
+    shadow.setShapeTransform(1.01, QPointF(2, 1));
+    QCOMPARE(shadow.maxBlurWithin(bounds), 1.0);
+
+    shadow.setShapeTransform(1.2, QPointF(0, 0));
+    QCOMPARE(shadow.maxBlurWithin(bounds), 0.0);
+}
+
+int main(int argc, char *argv[])
+{
+    EventTraceApplication app(argc, argv);
+    TestBeautyOpaque test(&app);
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "tst_beautyopaque.moc"
@@ -0,0 +1,110 @@
+#include <QEvent>
+#include <QGridLayout>
+#include <QtTest>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "beautyprogressbar.h"
+
+namespace {
+
+constexpr int kBars = 200;
+constexpr int kThreads = 32;
+constexpr int kRounds = 2000; // setValue calls per thread and bar
+
+// Counts the sampler's frames and every event that reaches a bar.
+class EventCounter : public QObject {
+public:
+    bool eventFilter(QObject *watched, QEvent *event) override
+    {
+        if (event->type() == QEvent::Timer) {
+            ++frames;
+        } else if (qobject_cast<BeautyProgressBar *>(watched)) {
+            ++barEvents;
+        }
+        return false;
+    }
+
+    quint64 frames { 0 };
+    quint64 barEvents { 0 };
+};
+
+} // namespace
+
+class TestBeautyProgressBar : public QObject {
+    Q_OBJECT
+
+private slots:
+    void setValueSendsNoEvents();
+    void disabledColors();
+};
+
+// 32 workers hammer 200 bars with 12.8 million updates between them; the GUI thread
+// must see at most one event per bar and frame however fast they write.
+void TestBeautyProgressBar::setValueSendsNoEvents()
+{
+    QWidget window;
+    auto *layout = new QGridLayout(&window);
+    std::vector<BeautyProgressBar *> bars;
+    for (int i = 0; i < kBars; ++i) {
+        auto *bar = new BeautyProgressBar(&window);
+        layout->addWidget(bar, i / 10, i % 10);
+        bars.push_back(bar);
+    }
+    window.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&window));
+    QCoreApplication::processEvents();
+
+    EventCounter counter;
+    qApp->installEventFilter(&counter);
+
+    std::atomic<int> running { kThreads };
+    std::vector<std::thread> workers;
+    for (int t = 0; t < kThreads; ++t) {
+        workers.emplace_back([&bars, &running] {
+            for (int round = 1; round <= kRounds; ++round) {
+                const int value = round * 100 / kRounds;
+                for (BeautyProgressBar *bar : bars) {
+                    bar->setValue(value);
+                }
+            }
+            running.fetch_sub(1, std::memory_order_release);
+        });
+    }
+    while (running.load(std::memory_order_acquire) > 0) {
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 16);
+    }
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+    QCoreApplication::processEvents();
+    qApp->removeEventFilter(&counter);
+    for (BeautyProgressBar *bar : bars) {
+        QCOMPARE(bar->value(), 100);
+    }
+
+    qInfo("%llu frames, %llu bar events for %lld updates", counter.frames, counter.barEvents,
+          qint64(kThreads) * kRounds * kBars);
+    QVERIFY(counter.barEvents <= (counter.frames + 1) * kBars);
+}
+
+void TestBeautyProgressBar::disabledColors()
+{
+    BeautyProgressBar bar;
+    bar.resize(100, 20);
+    bar.setValue(100);
+    bar.setTextVisible(false);
+    bar.setEnabled(false);
+    bar.setDisabledTrackColor(QColor(10, 20, 30));
+    bar.setDisabledColor(QColor(200, 100, 50));
+
+    // Sampling only eases shown bars; a hidden one jumps straight to its value.
+    QTRY_COMPARE(bar.grab().toImage().pixelColor(50, 10), QColor(200, 100, 50));
+}
+
+QTEST_MAIN(TestBeautyProgressBar)
+
+#include "tst_beautyprogressbar.moc"
@@ -0,0 +1,146 @@
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include "beautyrendercache.h"
+
+namespace {
+
+BeautyRenderCache::Raster buttonShadow()
+{
+    return BeautyRenderCache::instance().shadow(QSizeF(120, 32), 8, QColor(0, 0, 0, 100), 12, 1.0);
+}
+
+BeautyRenderCache::Raster buttonBody()
+{
+    return BeautyRenderCache::instance().body(QSizeF(120, 32), 8, QColor(210, 245, 210), 1.0);
+}
+
+QImage pixels(const BeautyRenderCache::Raster &raster)
+{
+    return raster.page.copy(raster.source);
+}
+
+bool writeFile(const QString &path, const QByteArray &bytes)
+{
+    QFile file(path);
+    return file.open(QIODevice::WriteOnly | QIODevice::Truncate) && file.write(bytes) == bytes.size();
+}
+
+} // namespace
+
+class TestBeautyRenderCache : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanup();
+    void saveThenLoad();
+    void saveOverLoadedFile();
+    void ignoresBadFiles_data();
+    void ignoresBadFiles();
+
+private:
+    QTemporaryDir m_dir;
+    QString m_valid;
+};
+
+// A file with one shadow and one body, the input every other test starts from.
+void TestBeautyRenderCache::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+    m_valid = m_dir.filePath(QStringLiteral("valid.bwcache"));
+
+    BeautyRenderCache &cache = BeautyRenderCache::instance();
+    cache.clear();
+    QVERIFY(!cache.setPersistentFile(m_valid));
+    QVERIFY(!buttonShadow().isNull());
+    QVERIFY(!buttonBody().isNull());
+    QVERIFY(cache.save());
+    QVERIFY(QFile::exists(m_valid));
+}
+
+void TestBeautyRenderCache::cleanup()
+{
+    BeautyRenderCache &cache = BeautyRenderCache::instance();
+    cache.setPersistentFile(QString());
+    cache.clear();
+}
+
+void TestBeautyRenderCache::saveThenLoad()
+{
+    BeautyRenderCache &cache = BeautyRenderCache::instance();
+    const QString path = m_dir.filePath(QStringLiteral("roundtrip.bwcache"));
+    QVERIFY(!cache.setPersistentFile(path));
+    const QImage shadow = pixels(buttonShadow());
+    const QImage body = pixels(buttonBody());
+    QVERIFY(cache.save());
+
+    cache.clear();
+    QCOMPARE(cache.entryCount(), 0);
+    QVERIFY(cache.setPersistentFile(path));
+    QCOMPARE(cache.entryCount(), 2);
+
+    const quint64 misses = cache.stats().misses;
+    QCOMPARE(pixels(buttonShadow()), shadow);
+    QCOMPARE(pixels(buttonBody()), body);
+    QCOMPARE(cache.stats().misses, misses);
+}
+
+// Saving replaces the file the loaded pages are mapped from, which Windows only allows
+// once nothing maps it any more; the loaded pages have to survive that.
+void TestBeautyRenderCache::saveOverLoadedFile()
+{
+    BeautyRenderCache &cache = BeautyRenderCache::instance();
+    const QString path = m_dir.filePath(QStringLiteral("resave.bwcache"));
+    QVERIFY(QFile::copy(m_valid, path));
+    QVERIFY(cache.setPersistentFile(path));
+    const QImage shadow = pixels(buttonShadow());
+
+    QVERIFY(!cache.body(QSizeF(80, 24), 12, QColor(200, 225, 250), 2.0).isNull());
+    QVERIFY(cache.save());
+    QCOMPARE(pixels(buttonShadow()), shadow);
+
+    cache.clear();
+    QVERIFY(cache.setPersistentFile(path));
+    QCOMPARE(cache.entryCount(), 3);
+    QCOMPARE(pixels(buttonShadow()), shadow);
+}
+
+void TestBeautyRenderCache::ignoresBadFiles_data()
+{
+    QFile file(m_valid);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QByteArray valid = file.readAll();
+    QVERIFY(valid.size() > 64);
+
+    // FileHeader: magic at 0, format at 4, library hash at 8.
+    QByteArray staleFormat = valid;
+    staleFormat[4] = char(staleFormat[4] + 1);
+    QByteArray staleLibrary = valid;
+    staleLibrary[8] = char(~staleLibrary[8]);
+
+    QTest::addColumn<QByteArray>("bytes");
+    QTest::newRow("empty") << QByteArray();
+    QTest::newRow("garbage") << QByteArray(4096, 'x');
+    QTest::newRow("truncated") << valid.left(valid.size() / 2);
+    QTest::newRow("stale format") << staleFormat;
+    QTest::newRow("other library build") << staleLibrary;
+}
+
+void TestBeautyRenderCache::ignoresBadFiles()
+{
+    QFETCH(QByteArray, bytes);
+    BeautyRenderCache &cache = BeautyRenderCache::instance();
+    const QString path = m_dir.filePath(QStringLiteral("bad.bwcache"));
+    QVERIFY(writeFile(path, bytes));
+
+    QVERIFY(!cache.setPersistentFile(path));
+    QCOMPARE(cache.entryCount(), 0);
+    QVERIFY(!buttonShadow().isNull());
+    QCOMPARE(cache.entryCount(), 1);
+}
+
+QTEST_MAIN(TestBeautyRenderCache)
+
+#include "tst_beautyrendercache.moc"
@@ -0,0 +1,118 @@
+#include <QFile>
+#include <QRegularExpression>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include <algorithm>
+
+#include "testforms.h"
+
+namespace {
+
+int countOf(const QList<TraceEvent> &events, QEvent::Type type, const QString &target)
+{
+    return int(std::count_if(events.cbegin(), events.cend(), [&](const TraceEvent &e) {
+        return e.type == quint16(type) && e.target == target;
+    }));
+}
+
+} // namespace
+
+class TestEventTrace : public QObject {
+    Q_OBJECT
+
+public:
+    explicit TestEventTrace(EventTraceApplication *app)
+        : m_app(app)
+    {
+    }
+
+private slots:
+    void initTestCase();
+    void recordsHoverAndTyping();
+    void replayReproducesTyping();
+    void unwritableReportFails();
+
+private:
+    EventTraceApplication *m_app;
+    QTemporaryDir m_dir;
+    QString m_trace;
+};
+
+void TestEventTrace::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+    m_trace = m_dir.filePath(QStringLiteral("session.bwtrace"));
+}
+
+// Every delivered event is recorded once: repeated moves on a widget that accepts
+// them are all kept, and a click the label ignores is not recorded again for the form.
+void TestEventTrace::recordsHoverAndTyping()
+{
+    auto form = makeForm();
+    form->show();
+    QVERIFY(QTest::qWaitForWindowActive(form.get()));
+    auto *edit = form->findChild<BeautyLineEdit *>(QStringLiteral("edit"));
+    auto *label = form->findChild<QLabel *>(QStringLiteral("label"));
+
+    {
+        EventRecorder recorder(form.get(), m_app);
+        QVERIFY(recorder.start(m_trace));
+        const QPoint c = edit->rect().center();
+        QTest::mouseMove(edit, c);
+        QTest::mouseMove(edit, c + QPoint(4, 0));
+        QTest::mouseMove(edit, c + QPoint(8, 0));
+        QTest::mouseClick(label, Qt::LeftButton);
+        QTest::mouseClick(edit, Qt::LeftButton, {}, c);
+        QTest::keyClicks(edit, QStringLiteral("abc"));
+    }
+    QCOMPARE(edit->text(), QStringLiteral("abc"));
+
+    const QList<TraceEvent> events = readTrace(m_trace);
+    QVERIFY(countOf(events, QEvent::MouseMove, QStringLiteral("edit")) >= 2);
+    QCOMPARE(countOf(events, QEvent::MouseButtonPress, QStringLiteral("label")), 1);
+    QCOMPARE(countOf(events, QEvent::MouseButtonPress, QStringLiteral("form")), 0);
+    QCOMPARE(countOf(events, QEvent::KeyPress, QStringLiteral("edit")), 3);
+    QCOMPARE(countOf(events, QEvent::KeyRelease, QStringLiteral("edit")), 3);
+}
+
+void TestEventTrace::replayReproducesTyping()
+{
+    auto form = makeForm();
+    form->show();
+    QVERIFY(QTest::qWaitForWindowActive(form.get()));
+
+    EventReplayer replayer(form.get(), m_app);
+    QVERIFY(replayer.load(m_trace));
+    QSignalSpy finished(&replayer, &EventReplayer::finished);
+    replayer.start(false, m_dir.filePath(QStringLiteral("report.txt")));
+    QVERIFY(finished.count() == 1 || finished.wait(5000));
+    QCOMPARE(finished.at(0).at(0).toBool(), true);
+    QCOMPARE(form->findChild<BeautyLineEdit *>(QStringLiteral("edit"))->text(), QStringLiteral("abc"));
+    QVERIFY(QFile::exists(m_dir.filePath(QStringLiteral("report.txt"))));
+}
+
+void TestEventTrace::unwritableReportFails()
+{
+    auto form = makeForm();
+    form->show();
+    QVERIFY(QTest::qWaitForWindowExposed(form.get()));
+
+    EventReplayer replayer(form.get(), m_app);
+    QVERIFY(replayer.load(m_trace));
+    QSignalSpy finished(&replayer, &EventReplayer::finished);
+    QTest::ignoreMessage(QtCriticalMsg, QRegularExpression(QStringLiteral("^Cannot write report")));
+    replayer.start(false, m_dir.filePath(QStringLiteral("missing/report.txt")));
+    QVERIFY(finished.count() == 1 || finished.wait(5000));
+    QCOMPARE(finished.at(0).at(0).toBool(), false);
+}
+
+int main(int argc, char *argv[])
+{
+    EventTraceApplication app(argc, argv);
+    TestEventTrace test(&app);
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "tst_eventtrace.moc"